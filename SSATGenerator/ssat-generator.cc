@@ -5,6 +5,8 @@
 //  edited 1 March 2016
 
 //  Compile with:  g++ ssat-generator.cc -o ssat-generator
+//  With -b as the first argument, it writes the formula to temp.ssatb (the
+//  binary format the solver loads without parsing) instead of solving it
 
 
 // Includes
@@ -18,6 +20,8 @@
 #include <ctime>
 #include <cstring>
 #include <map>
+#include <algorithm>
+#include <stdint.h>
 
 //A
 #include <sstream>
@@ -56,6 +60,22 @@ using namespace std;
 #define VARWIDTH 5
 #define VALWIDTH 12
 
+#define SSATB_VERSION 1         // must match ssat.cc
+
+// start of a .ssatb file; the layout must match ssatbHeader in ssat.cc
+struct ssatb_header {
+	char magic[4];
+	uint32_t version;
+	int32_t numvars;
+	int32_t numclauses;
+	int32_t max_clause_length;
+	int32_t min_clause_length;
+	int32_t seed;
+	int32_t reserved;
+	double average_clause_length;
+	uint64_t numliterals;
+};
+
 // Command line arguments
 long numvars;         // file containing the SSAT encoding
 long numclauses;         // low threshold success probability (minimum acceptable)
@@ -80,6 +100,7 @@ long ***vc;                   // structure holding clause lists for each literal
 double make_ssat(long seeed);
 bool alreadyin(long c, long numlit, long newlit);
 void print_ssat_numbers();
+void write_ssatb(long seed, double average_clause_length);
 
 // functions to solve SSAT problem
 double solve_ssat(long node);
@@ -98,7 +119,13 @@ ofstream file;
 
 int main(int argc, char *argv[]) {
 
-	file.open("temp.ssat");
+	// -b: binary output
+	bool binary = false;
+	if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+		binary = true;
+		++argv;
+		--argc;
+	}
 
 	// make sure all arguments are present
 	if (argc < NUM_BASIC_ARGS) {
@@ -165,6 +192,13 @@ int main(int argc, char *argv[]) {
 	// generate the SSAT formula
 	double average_clause_length = make_ssat(seed);
 
+	if (binary) {
+		write_ssatb(seed, average_clause_length);
+		return 0;
+	}
+
+	file.open("temp.ssat");
+
 	file << endl;
 	file << ";  command               = ";
 	for (int a = 0 ; a < argc ; a++)
@@ -244,11 +278,11 @@ double make_ssat(long seed) {
 			exit(-1);
 		}
 
-	// for now, just allocate space to count number of clauses that
-	// each literal is in
+	// room for the count of clauses that each literal is in, followed by
+	// those clauses (at most one per clause)
 	for (long v = 1 ; v <= numvars ; ++v) {
 		for (long s = 0 ; s <= 1 ; ++s)
-			if ((vc[v][s] = (long *) malloc(sizeof(long)))  == NULL) {
+			if ((vc[v][s] = (long *) malloc((numclauses + 1) * sizeof(long)))  == NULL) {
 				cerr << "Error: insufficient memory to allocate vc array" << endl;
 				exit(-1);
 			}
@@ -437,6 +471,57 @@ void print_ssat_numbers() {
 }
 
 
+// writes the formula to temp.ssatb: the header, the probabilities (-1.0 for
+// choice variables, starting at an unused variable 0), the offset of every
+// clause in the literals (plus the end), and the literals, each clause sorted
+// as the solver keeps them
+//
+void write_ssatb(long seed, double average_clause_length) {
+
+	ssatb_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "SSTB", 4);
+	header.version = SSATB_VERSION;
+	header.numvars = numvars;
+	header.numclauses = numclauses;
+	header.max_clause_length = max_clause_length;
+	header.min_clause_length = min_clause_length;
+	header.seed = seed;
+	header.average_clause_length = average_clause_length;
+
+	double probs[VARS + 1];
+	probs[0] = CHOICEVAR;
+	for (long v = 1 ; v <= numvars ; v++)
+		probs[v] = chancevarprob[v];
+
+	int32_t *starts = new int32_t[numclauses + 1];
+	int32_t *lits = new int32_t[numclauses * LPC];
+	long numlits = 0;
+	for (long c = 0 ; c < numclauses ; c++) {
+		starts[c] = numlits;
+		for (long l = 0 ; l < lic[c] ; l++) {
+			if (sgn[c][l] == NOTNEGATED)
+				lits[numlits++] = form[c][l];
+			else
+				lits[numlits++] = -form[c][l];
+		}
+		sort(lits + starts[c], lits + numlits);
+	}
+	starts[numclauses] = numlits;
+	header.numliterals = numlits;
+
+	ofstream out("temp.ssatb", ios::binary);
+	out.write((const char *) &header, sizeof(header));
+	out.write((const char *) probs, (numvars + 1) * sizeof(double));
+	out.write((const char *) starts, (numclauses + 1) * sizeof(int32_t));
+	out.write((const char *) lits, numlits * sizeof(int32_t));
+	out.close();
+
+	delete [] starts;
+	delete [] lits;
+}
+
+
 void print_clause(long c) {
 
 	file << "( ";
@@ -13,11 +13,11 @@
  Run this program with two arguments on the command line
  the input file and the algorithm
  
- g++ -Wall -o ssat ssat.cc
+ g++ -Wall -pthread -o ssat ssat.cc
  ./ssat [file name]
  
  Running on dover: 
- g++ -std=c++11 -Wall -o ssat ssat.cc
+ g++ -std=c++11 -Wall -pthread -o ssat ssat.cc
  ./ssat [file name]
   
  ******************************************************************************/
@@ -32,10 +32,35 @@
 #include <cstdlib>
 #include <cmath>
 #include <algorithm>
-#include <map>
-#include <set>
+#include <functional>
+#include <cstring>
+#include <cctype>
 #include <ctime>
 #include <climits>
+#include <cstdint>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <glob.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef SSAT_STATS
+#include <sys/resource.h>
+#endif
+
+//hardware counters for --perf, only on linux and only in a stats build
+#if defined(SSAT_STATS) && defined(__linux__)
+#define SSAT_PERF
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
 
 using namespace std;
 
@@ -58,61 +83,696 @@ static const unsigned int MAXVAR = 5;
 static const unsigned int MINCLAUSE = 6;
 static const unsigned int MAXCLAUSE = 7;
 static const unsigned int PERCENTAGE = 100;
+static const string ALGORITHM_NAMES[] = {"NAIVE", "UCPONLY", "PVEONLY", "UCPPVE", "RANDOMVAR", "MAXVAR", "MINCLAUSE", "MAXCLAUSE"};
+
+//how an algorithm picks the variable to split on
+static const int SPLIT_FIRST = 0;           // the first active variable of the prefix
+static const int SPLIT_RANDOM = 1;          // a random one of the current block
+static const int SPLIT_SCORED = 2;          // the best one of the current block by its score
+
+//splits an algorithm makes grow about like 2^(variables * exponent), only used
+//to start the longest batch jobs first. Every value is the mean over the 18
+//files of newProblems (36 variables each) of log2(NUM OF VS + 1) / 36, from
+//default runs (no shortcuts, RANDOMVAR with seed 1); over the files they range
+//by about +-0.15, which is enough to order the jobs but no finer
+static const double SPLIT_EXPONENT[] = {0.66, 0.50, 0.58, 0.41, 0.41, 0.35, 0.38, 0.40};
+
+//what the split heuristics keep a score of for every variable, so that the
+//best variable of a block is always at the top of its heap
+static const int SCORE_NONE = 0;            // no scores (the heuristic does not need them)
+static const int SCORE_OCCURRENCES = 1;     // number of active clauses the variable is in
+static const int SCORE_LARGEST_CLAUSE = 2;  // size of its largest active clause
+static const int SCORE_SMALLEST_CLAUSE = 3; // size of its smallest active clause, negated
+static const int SCORE_KINDS[] = {SCORE_NONE, SCORE_NONE, SCORE_NONE, SCORE_NONE, SCORE_NONE,
+                                  SCORE_OCCURRENCES, SCORE_SMALLEST_CLAUSE, SCORE_LARGEST_CLAUSE};
+static const int NO_SCORE = INT_MIN;        // the variable is in no active clause the score counts
+//default --heap-min-vars: smaller blocks are scanned. Timed with MAXVAR on
+//blocks of 9 to 500 variables (the bundled files and ssat-generator ones, 500
+//being its limit), the heap was 0-30% slower at every size: picking the
+//variable is about 1% of the search, less than keeping the heap up to date
+//through the pure variables every split assigns costs
+static const int HEAP_MIN_VARS = 512;
+
+//kinds of changes recorded on the trail
+static const int TRAIL_ASSIGNED = 0;        // a variable got a value
+static const int TRAIL_SATISFIED = 1;       // a clause became satisfied (inactive)
+static const int TRAIL_HIDDEN = 2;          // a literal of a clause became false
+static const int TRAIL_INACTIVE = 3;        // a variable is in no active clause anymore
+static const int TRAIL_SET_ASIDE = 4;       // a clause belongs to another component
+static const int TRAIL_VAR_SET_ASIDE = 5;   // a variable belongs to another component
+
+//what a frame of the search does when it is back on top of the frame stack
+static const int STAGE_ENTER = 0;           // look the formula up and simplify it
+static const int STAGE_COMPONENT = 1;       // a component was solved
+static const int STAGE_FALSE_BRANCH = 2;    // the FALSE branch of the split was solved
+static const int STAGE_TRUE_BRANCH = 3;     // the TRUE branch of the split was solved
+
+static const double DEFAULT_CACHE_MB = 64;  // memory cap of the formula cache with --fast
+static const unsigned int CACHE_PROBES = 8; // slots searched for a key before evicting
+static const unsigned int MIN_CACHE_SLOTS = 1024;
+static const int WORD_BITS = 64;
+static const char SSATB_MAGIC[4] = {'S', 'S', 'T', 'B'};
+static const uint32_t SSATB_VERSION = 1;
+
+//what a cached probability is, for a search that was cut short by its window
+static const int CACHE_EXACT = 0;           // the probability of the formula
+static const int CACHE_UPPER = 1;           // the probability is at most this
+static const int CACHE_LOWER = 2;           // the probability is at least this
+//phases of the search timed by a build with SSAT_STATS
+static const int PHASE_NONE = -1;
+static const int PHASE_UCP = 0;             // propagateUnits, without the updates it makes
+static const int PHASE_PVE = 1;             // eliminatePureChoices, without the updates it makes
+static const int PHASE_HEURISTIC = 2;       // choosing the variable to split on
+static const int PHASE_UPDATE = 3;          // updateClausesAndVariables
+static const int PHASE_UNDO = 4;            // undoChanges
+static const int NUM_PHASES = 5;
+static const char* const PHASE_NAMES[] = {"ucp", "pve", "heuristic", "update", "undo"};
+
+//hardware events counted by --perf, in a stats build on linux
+static const int NUM_HW_EVENTS = 4;
+static const char* const HW_EVENT_NAMES[] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+
+static const unsigned int DEFAULT_SEED = 1;   // seed of RANDOMVAR when none is given
+
+static const int COMPONENT_MIN_VARS = 20;   // smaller formulas are not worth the search for components
+static const int LEAF_MAX_VARS = 10;        // with --fast, formulas with at most this many variables are solved by solveLeaf
+static const int LEAF_VARS_LIMIT = 16;      // largest --leaf-vars, the truth table has 2^n bits
+static const int BITSET_MAX_WORDS = 4;      // the bitset engine takes up to 64 * this many variables
+static const int BITSET_FRAME_COUNTS = 4;   // hash, active variables, active clauses and UNSAT after bitState in a frame
+static const int TASK_MIN_VARS = 12;        // smaller subtrees are not worth handing to another thread
+static const unsigned int MAX_HELP_DEPTH = 16;  // stolen subtrees a waiting thread may stack up
+
+//steps of preprocess, in the order they run
+static const int PREPROCESS_TAUTOLOGIES = 0;    // clauses with a literal and its negation
+static const int PREPROCESS_DUPLICATES = 1;     // clauses with the same literals as an earlier one
+static const int PREPROCESS_SUBSUMPTION = 2;    // clauses with every literal of another clause
+static const int PREPROCESS_STRENGTHENING = 3;  // literals self-subsuming resolution takes out
+static const int NUM_PREPROCESS_STEPS = 4;
+static const char* const PREPROCESS_NAMES[] = {"tautologies", "duplicates", "subsumption", "strengthening"};
 
 /***************************************************************************/
 /* structs */
-typedef struct varInfo{
-    double quantifier;              // choice/chance (probability if chance)
-    map<int, int> clauseMembers;    // key: index of the clauses the var is in
-                                    // value: POS/NEG in its respective clauses
-} varInfo;
+
+//the clauses are stored in one contiguous arena instead of a map of sets:
+//literals of clause c are literals[clauseStart[c]] .. literals[clauseStart[c+1] - 1],
+//and the clauses variable v appears in are occurrences[occurrenceStart[v]] ..
+//occurrences[occurrenceStart[v+1] - 1] (in increasing clause order), with the
+//sign of v in that clause at the same position in occurrenceSign
+typedef struct clauseDB {
+    vector<int> literals;           // every clause's literals, packed back to back
+    vector<int> clauseStart;        // offset of each clause in literals (+1 sentinel)
+    vector<int> occurrences;        // clause indices of every variable, packed
+    vector<int> occurrenceSign;     // POS/NEG of the variable in that clause
+    vector<int> occurrenceStart;    // offset of each variable in occurrences (+1 sentinel)
+} clauseDB;
+
+//one change made to the search state by an assignment; undoing is popping
+//these back to the trail size saved before the assignment
+typedef struct trailEntry {
+    int kind;                       // TRAIL_ASSIGNED, TRAIL_SATISFIED, ...
+    int index;                      // the variable or clause that changed
+} trailEntry;
+
+//one memoized residual formula: the formula key (active clauses and active
+//variables as a bitset) lives in the cache's key pool at the same slot number
+typedef struct cacheSlot {
+    unsigned long long hash;        // zobrist hash of the key, 0 if the slot is empty
+    double probability;             // probability of satisfaction of the formula
+    unsigned int work;              // variable splits it took to solve, for eviction
+    int bound;                      // CACHE_EXACT, CACHE_UPPER or CACHE_LOWER
+} cacheSlot;
+
+//open-addressing table of solved residual formulas. It starts small and
+//doubles until maxSlots (set by the memory cap) is reached; after that a new
+//formula evicts the cheapest-to-recompute entry among the slots it probes
+typedef struct formulaCache {
+    vector<cacheSlot> slots;
+    vector<unsigned long long> keys;    // keyWords words per slot
+    unsigned int keyWords;
+    size_t used;
+    size_t maxSlots;
+} formulaCache;
+
+//while it exists, the time of its state is charged to one phase; the phase
+//that was being timed before goes on when it is destroyed. Only built with
+//SSAT_STATS, otherwise STATS_PHASE is nothing
+#ifdef SSAT_STATS
+typedef struct phaseTimer {
+    struct formulaState* state;
+    int outer;
+    
+    phaseTimer(struct formulaState* timed, int phase);
+    ~phaseTimer();
+} phaseTimer;
+#define STATS_PHASE(phase) phaseTimer phaseTimer_(this, phase)
+
+//the hardware event counters of one thread, as one perf group so they all
+//count over the same time. Opened the first time the thread reads them
+typedef struct perfCounters {
+    bool opened;
+    int groupFd;                    // -1 if no event could be opened
+    int fds[NUM_HW_EVENTS];         // -1 for the events this machine does not have
+    int slot[NUM_HW_EVENTS];        // position of every event in a read of the group
+    int numSlots;
+    
+    perfCounters();
+    ~perfCounters();
+    void open();
+    bool read(unsigned long long* values);
+} perfCounters;
+#else
+#define STATS_PHASE(phase)
+#endif
+
+//answer to "is the probability of satisfaction at least threshold?", with
+//the interval [lower, upper] the probability was narrowed down to on the way
+typedef struct thresholdDecision {
+    double threshold;
+    bool satisfied;
+    double lower;
+    double upper;
+} thresholdDecision;
+
+typedef struct splitTask splitTask;
+typedef struct solverContext solverContext;
+
+//one subformula being solved by SOLVESSAT: its window, where it is in its
+//search, and what it has to keep until the branch or component it pushed is
+//solved. Every formula state has a stack of them in place of native calls
+typedef struct searchFrame {
+    double low;                     // window of the formula
+    double high;
+    int stage;                      // STAGE_ENTER, STAGE_COMPONENT, ...
+    bool cached;                    // its probability goes into the cache once it is solved
+    int splitsBefore;               // splits and bounds before it was solved, for the cache
+    int boundsBefore;
+    unsigned int level;             // trail size when it was entered
+    unsigned int branchLevel;       // trail size after its units and pure variables
+    double unitProbability;         // product of the chance probabilities of its units
+    double lower;                   // window of the formula left after them
+    double upper;
+    int variable;                   // split variable
+    double falseValue;              // probability of the FALSE branch
+    double childLower;              // window of the open branch or component, before clipping
+    double childUpper;
+    double stolenLower;             // window of the TRUE branch offered to other threads
+    double stolenUpper;
+    splitTask* task;                // that branch, NULL if it was not offered
+    unsigned int scratch;           // where its components are on the scratch stack
+    unsigned int firstLabel;        // label of its first component (clause arena)
+    int numComponents;
+    int component;                  // the component being solved
+    double product;                 // of the components solved so far
+} searchFrame;
+typedef struct formulaState formulaState;
+
+//what an algorithm does at every node, as a type: the search is compiled once
+//for every policy, with the steps it does not take compiled out
+template <bool units, bool pures, int split, int bitWords>
+struct searchPolicy {
+    static const bool propagate = units;    // unit clause propagation
+    static const bool eliminate = pures;    // pure choice elimination
+    static const int heuristic = split;     // SPLIT_FIRST, SPLIT_RANDOM or SPLIT_SCORED
+    static const int words = bitWords;      // words of a variable mask of the bitset engine, 0 for the clause arena
+};
+
+//the search of one policy, as SOLVESSAT<policy>
+typedef double (formulaState::*solverKernel)(double low, double high);
+
+//start of a .ssatb file, the binary form of a .ssat file. The quantifiers,
+//clause offsets and literals follow it (see writeBinary). A change of the
+//layout needs a new SSATB_VERSION
+typedef struct ssatbHeader {
+    char magic[4];                  // SSATB_MAGIC
+    uint32_t version;
+    int32_t numVars;
+    int32_t numClauses;
+    int32_t maximumClauseLength;
+    int32_t minimumClauseLength;
+    int32_t seed;
+    int32_t reserved;
+    double averageClauseLength;
+    uint64_t numLiterals;
+} ssatbHeader;
+
+//timings of one (instance, algorithm) job of the benchmark, over its runs;
+//also one line of a benchmark results file
+typedef struct benchResult {
+    string instance;
+    string algorithm;
+    int runs;
+    double timeMedian;              // seconds of wall time
+    double timeP90;
+    double timeMin;
+    double timeMax;
+    double nodeRateMedian;          // formulas searched per second
+    double nodeRateP90;
+    double nodeRateMin;
+    double nodeRateMax;
+    long long nodes;                // of the last run
+    double probability;
+} benchResult;
+
+//a position in a file mapped into memory, for parsing it without copies
+typedef struct textScanner {
+    const char* at;
+    const char* end;
+    
+    bool skipBlanks();
+    void skipSpaces();
+    void skipLine();
+    bool skipPast(char c);
+    bool matchWord(const char* word);
+    bool readInt(int* value);
+    bool readDouble(double* value);
+} textScanner;
+
+//what one step of preprocess took out of the formula, and the time it took
+typedef struct preprocessStats {
+    double seconds;
+    int clauses;                    // clauses removed
+    int literals;                   // literals removed, those of the removed clauses included
+} preprocessStats;
+
+//one parsed .ssat file: the formula as read, never modified while solving,
+//and the state every search on it starts from. Any number of them can be
+//loaded at the same time
+typedef struct ssatInstance {
+    string name;                    // the file it was read from
+    int maximumClauseLength;
+    int minimumClauseLength;
+    double averageClauseLength;
+    int seed;
+    int numVars;
+    int numClauses;
+    clauseDB db;
+    vector<double> quantifier;      // choice/chance (probability if chance), starts indexing at 1
+    vector<unsigned long long> zobrist;     // random code of every clause, then every variable
+    
+    //the prefix split into quantifier blocks, runs of consecutive variables that
+    //are all choice or all chance: block b is variables blockStart[b] .. blockStart[b+1] - 1
+    int numBlocks;
+    vector<int> blockStart;
+    vector<char> blockChoice;       // the block's variables are choice variables
+    vector<int> varBlock;           // block of every variable
+    
+    formulaState* initialState;     // every clause and variable active, copied for every new state
+    double parseTime;               // seconds readFile took, without preprocess
+    int numClausesRead;             // clauses in the file, before preprocess
+    preprocessStats preprocessSteps[NUM_PREPROCESS_STEPS];
+#ifdef SSAT_STATS
+    unsigned long long parseEvents[NUM_HW_EVENTS];  // hardware events readFile took
+#endif
+    
+    bool readFile(string input);
+    bool parseText(const char* text, size_t size);
+    bool loadBinary(const char* data, size_t size);
+    bool writeBinary(string output);
+    void preprocess();
+    void buildOccurrences();
+    void buildBlocks();
+    void initZobrist();
+} ssatInstance;
+
+//the clauses of a formula while preprocess simplifies them, each a sorted
+//vector of its literals. A removed clause keeps its place (and its entries
+//in the occurrence lists, which are only ever read) until store
+typedef struct formulaSimplifier {
+    vector<vector<int> > clauses;
+    vector<char> removed;
+    vector<unsigned long long> signature;   // bit literalCode % 64 set for every literal of the clause
+    vector<vector<int> > occurrences;       // clauses every literal code was in when loaded
+    vector<char> marked;                    // literal codes of the clause being compared
+    
+    void load(const clauseDB &db, int numVars, int numClauses);
+    void store(clauseDB &db, int* numClauses);
+    void removeClause(int clause, preprocessStats &stats);
+    void removeTautologies(preprocessStats &stats);
+    void removeDuplicates(preprocessStats &stats);
+    void removeSubsumed(preprocessStats &stats);
+    void subsumeFrom(int clause, preprocessStats &stats);
+    void strengthen(preprocessStats &stats);
+    int countMarked(int clause);
+    unsigned long long clauseSignature(int clause, int skipped, int added);
+} formulaSimplifier;
+
+//counts of what a search did. Every formula state keeps its own, and the
+//reported numbers are the sums over all states of a run
+typedef struct searchCounters {
+    int numUCP;
+    int numPVE;
+    int numVS;
+    int numCacheHits;
+    int numCacheMisses;
+    int numCacheBoundHits;          // cache hits that were a bound, not the exact value
+    int numComponentSplits;
+    int numChoicePrunes;            // second branches that could not beat the first
+    int numChanceLowerPrunes;       // second branches that could not lift a chance node to its window
+    int numChanceUpperPrunes;       // second branches not needed, the chance node is above its window
+    int numComponentPrunes;         // components not solved, the product is already below its window
+    int numBoundJoins;              // stolen branches that came back as a bound
+    long long numNodes;             // formulas searched (not decided on entry or by the cache)
+    int numStolenTasks;             // subtrees taken over from another thread
+    int numLeafSolves;              // formulas solved from their truth table instead of by splits
+#ifdef SSAT_STATS
+    long long phaseNanos[NUM_PHASES];       // time spent in every phase, not in the phases it calls
+    long long phaseCalls[NUM_PHASES];
+    vector<long long> depthHistogram;       // nodes by number of variables gone from the formula
+    unsigned long long phaseEvents[NUM_PHASES][NUM_HW_EVENTS];  // hardware events in every phase
+    unsigned long long searchEvents[NUM_HW_EVENTS];             // hardware events of the whole search
+    unsigned long long searchAllocations;   // heap allocations the search made on the state's thread
+#endif
+    
+    void resetResult();
+    int numPrunes();
+    int numInexact();
+    void addCounters(const searchCounters &other);
+} searchCounters;
+
+//everything a search changes while it runs, on top of the formula as read.
+//Every thread has its own, so no two threads ever touch the same state
+typedef struct formulaState : searchCounters {
+    const clauseDB &db;             // the instance the state searches
+    const vector<double> &quantifier;
+    const vector<unsigned long long> &zobrist;
+    const vector<int> &blockStart;
+    const vector<char> &blockChoice;
+    const vector<int> &varBlock;
+    int numVars;
+    int numClauses;
+    int numBlocks;
+    
+    vector<int> assignment;         // POSITIVE/NEGATIVE if assigned, INVALID otherwise
+    vector<char> varActive;         // variable is still part of the formula (old variables map)
+    vector<int> positiveMembers;    // number of active clauses the variable is positive in
+    vector<int> negativeMembers;    // number of active clauses the variable is negative in
+    vector<char> clauseActive;      // clause is not satisfied yet (old clauses map), starts at 0
+    vector<int> clauseSize;         // number of literals of the clause that are not false
+    int numActiveVars;
+    int numActiveClauses;
+    bool UNSATclauseExists;         // indicate existence of unsatisfiable clause
+    
+    //the active variables of every quantifier block: those of block b are
+    //blockVars[blockStart[b]] .. blockVars[blockStart[b] + blockActive[b] - 1],
+    //in no particular order, and its inactive ones follow them
+    vector<int> blockVars;
+    vector<int> blockPosition;      // where every variable is in blockVars
+    vector<int> blockActive;        // number of active variables of every block
+    bool trackBlocks;               // keep them up to date (only the split heuristics need them)
+    
+    //with a score kind, every block also has a max-heap on the scores of its
+    //variables (ties to the lower variable), heapVars[blockStart[b]] ..
+    //heapVars[blockStart[b] + heapSize[b] - 1]. Every active variable is in
+    //it, and inactive ones are only taken out when they get to the top
+    int scoreKind;
+    vector<int> heapVars;
+    vector<int> heapPosition;       // where every variable is in heapVars, -1 if not in the heap
+    vector<int> heapSize;
+    vector<char> varHeaped;         // the variable's block has a heap
+    vector<int> score;              // score of every variable, as it is in the heap
+    vector<char> scoreDirty;        // the variable's counts changed since it was scored
+    vector<int> dirtyVars;          // those variables, scored again before the next split
+    bool trackSizes;                // the score needs the sizes of the variables' clauses
+    int sizeWidth;                  // longest clause + 1
+    vector<int> sizeCount;          // active clauses of every size, sizeWidth per variable
+    vector<int> sizeBound;          // largest or smallest of those sizes, 0 if none
+    
+    vector<trailEntry> trail;       // every change since the root, in order
+    vector<searchFrame> frames;     // the subformulas SOLVESSAT is in, innermost last
+    vector<int> unitQueue;          // min-heap of clauses that dropped to one literal
+    vector<int> pureQueue;          // min-heap of choice variables that may have become pure
+    
+    //the residual formula is determined by which clauses and variables are still
+    //active, so that bitset (clauses first, then variables) is its canonical key
+    vector<unsigned long long> formulaKey;
+    unsigned long long formulaHash; // xor of the zobrist codes of everything active
+    formulaCache* cache;            // shared by all states of the same thread
+    
+    vector<unsigned int> varComponent;      // last component label given to each variable
+    vector<unsigned int> clauseComponent;   // last component label given to each clause
+    vector<int> componentQueue;             // variables waiting to be expanded by labelComponent
+    unsigned int componentLabel;            // labels only grow, so marks never need clearing
+    vector<int> componentScratch;           // (clause or variable, label) pairs of the open splits
+    
+    vector<int> leafVars;                   // the variables of the formula solveLeaf solves, in prefix order
+    vector<int> leafBit;                    // bit of every one of them in an assignment of leafVars
+    vector<unsigned long long> leafTable;   // bit a is set if assignment a satisfies every clause
+    vector<unsigned long long> leafClause;  // the same for one clause
+    vector<double> leafValues;              // probability of every assignment of the outer variables
+    
+    //the bitset engine, for instances of at most 64 * BITSET_MAX_WORDS variables
+    //with no variable twice in a clause: variable v is bit v - 1 of a mask of
+    //bitWords words and clause c bit c of a mask of clauseWords words. The
+    //search state is bitState: the assigned variables, the active variables,
+    //those in an active clause positively and negatively, then the active
+    //clauses. Every change first saves bitState (and the counts that go with
+    //it) as a frame and puts one entry on the trail, so undoing is copying
+    //one frame back
+    int bitWords;                           // 0 if the instance cannot use the engine
+    int clauseWords;
+    vector<unsigned long long> bitPositive; // variables positive in every clause, bitWords each
+    vector<unsigned long long> bitNegative;
+    vector<unsigned long long> bitPositiveIn;   // clauses every variable is positive in, clauseWords each
+    vector<unsigned long long> bitNegativeIn;
+    vector<unsigned long long> bitChoice;   // the choice variables
+    vector<unsigned long long> bitBlock;    // the variables of every quantifier block
+    vector<unsigned long long> bitState;
+    vector<unsigned long long> bitFrames;   // bitState before every change on the trail, and its counts
+    vector<unsigned long long> bitUnits;    // clauses that dropped to one literal (the unit queue)
+    vector<unsigned long long> bitPures;    // choice variables that may have become pure (the pure queue)
+    vector<unsigned long long> bitScratch;  // clauses and variables of the components of the open splits
+    vector<int> bitSizes;                   // sizes of the active clauses, for the scored heuristics
+    
+    mt19937 random;                 // RANDOMVAR's choices, seeded again by every run
+    solverContext* context;         // the run the state belongs to
+    int worker;                     // thread of that run the state belongs to
+    unsigned int depth;             // how many waiting searches of that thread are below it
+#ifdef SSAT_STATS
+    int phase;                      // the phase being timed, PHASE_NONE outside of them
+    long long phaseStart;           // when it was last entered or resumed
+    unsigned long long phaseEventStart[NUM_HW_EVENTS];  // hardware events at that time
+#endif
+    
+    formulaState(const ssatInstance &instance);
+    template <class policy> double SOLVESSAT(double low, double high);
+    void pushFrame(double low, double high);
+    template <class policy> double leaveFormula(searchFrame &frame, double probability);
+    template <class policy> bool enterFormula(searchFrame &frame, double* probability);
+    template <class policy> bool resumeFalseBranch(searchFrame &frame, double* probability);
+    template <class policy> bool resumeTrueBranch(searchFrame &frame, double* probability);
+    template <class policy> double finishSplit(searchFrame &frame, double probSAT);
+    template <class policy> void openComponent(searchFrame &frame);
+    template <class policy> bool resumeComponents(searchFrame &frame, double* probability);
+    vector<thresholdDecision> decideSSAT(solverKernel kernel, const vector<double> &thresholds);
+    pair<bool, int> isPureChoice(int variable);
+    void updateClausesAndVariables(int variable, int value);
+    void undoChanges(unsigned int level);
+    double propagateUnits();
+    void eliminatePureChoices();
+    void initQueues();
+    void toggleClause(int clause);
+    void toggleVariable(int variable);
+    void deactivateVariable(int variable);
+    void reactivateVariable(int variable);
+    int firstBlock();
+    int nextBlock(int block);
+    void initFormulaKey();
+    void initRoot();
+    void reserveScratch();
+    bool lookupCache(double low, double high, double* probability);
+    void storeCache(double probability, int bound, unsigned int work);
+    bool findComponents(searchFrame &frame);
+    void enterComponent(searchFrame &frame);
+    int labelComponent(int start, unsigned int label);
+    double solveLeaf();
+    void addLeafLiteral(int bit, bool positive, int words);
+    bool andLeafClause(int words);
+    double foldLeaf();
+    void clearQueues();
+    template <class policy> void setVariable(int variable, int value);
+    template <class policy> void undoTo(unsigned int level);
+    void initBitset();
+    void bitSave(int kind, int index);
+    void bitUndo(unsigned int level);
+    template <int W> void bitAssign(int variable, int value);
+    template <int W> int bitClauseSize(int clause);
+    template <int W> double bitPropagate();
+    template <int W> void bitEliminate();
+    template <int W> void bitSyncKey();
+    template <int W> int bitFirstVar();
+    template <int W> int bitScoredVar();
+    template <int W> double bitLeaf();
+    template <int W> bool bitFindComponents(searchFrame &frame);
+    template <int W> void bitEnterComponent(searchFrame &frame);
+    template <int W> int bitLabel(int start, unsigned int at);
+    void setAsideClause(int clause);
+    void setAsideVariable(int variable);
+    splitTask* offerTask(int variable, double low, double high);
+    void releaseTask();
+    bool reclaimTask(splitTask* task);
+    double joinTask(splitTask* task);
+    void runTask(splitTask* task);
+    int unassigned_var();
+    void printVariables();
+    void printClauses();
+    int randomSH();
+    int scoredSH();
+    void initScores(int kind);
+    int variableScore(int variable);
+    bool betterScore(int first, int second);
+    void markScore(int variable);
+    void rescoreVariable(int variable);
+    void siftUp(int variable);
+    void siftDown(int variable);
+    void pushHeap(int variable);
+    void popHeap(int block);
+    void addClauseSize(int variable, int size);
+    void removeClauseSize(int variable, int size);
+    void resizeClause(int clause, int from, int to);
+} formulaState;
+
+//one thread of a parallel search: its formula states (one for the search it
+//runs and one more for every stolen subtree it works on while it waits), its
+//cache, and the subtrees it offers to the other threads
+typedef struct searchWorker {
+    vector<formulaState*> states;
+    formulaCache cache;
+    deque<splitTask*> tasks;        // the thread adds and reclaims at the back, thieves take the front
+    mutex tasksLock;
+    deque<splitTask> offered;       // the tasks of the open splits of its states, innermost last
+    unsigned int numOffered;        // how many of them are in use
+} searchWorker;
+
+//a subtree offered to idle threads: the changes that lead to it from the
+//root, to be replayed on the thief's own formula state, and its window
+typedef struct splitTask {
+    vector<trailEntry> path;
+    double low;
+    double high;
+    double probability;
+    bool exact;                     // the probability is not a bound
+    atomic<bool> done;
+} splitTask;
+
+//one run of one algorithm on the parsed formula, with everything that run
+//changes: its threads and their formula states, caches and task queues, and
+//what it found. Runs share nothing but the formula, so any number of them
+//can go on at the same time
+typedef struct solverContext {
+    const ssatInstance* instance;
+    unsigned int algorithm;
+    solverKernel kernel;            // the search compiled for the algorithm
+    unsigned int seed;              // of the random choices of RANDOMVAR
+    vector<searchWorker*> workers;  // workers[0] is the thread that calls solve
+    atomic<int> numIdleWorkers;     // threads looking for a subtree to steal
+    atomic<int> numOpenTasks;       // subtrees offered and not taken yet
+    atomic<bool> searchFinished;    // tells the helper threads to stop
+    mutex idleLock;
+    condition_variable workChanged; // a task was offered or solved, or the search finished
+    atomic<int> numSleeping;        // threads waiting on workChanged
+    vector<thread> helperThreads;
+    
+    //results of the last solve
+    double probSAT;
+    vector<thresholdDecision> decisions;
+    bool bitset;                    // the search ran on the bitset engine
+    searchCounters totals;          // over all threads
+    vector<long long> threadNodes;  // formulas searched on every thread
+    double solutionTime;
+    
+    void solve();
+    void startWorkers();
+    void stopWorkers();
+    void workerLoop(int worker);
+    bool stealTask(int worker, unsigned int depth);
+    void waitForWork(const splitTask* joined, bool canSteal);
+    void wakeWorkers();
+    formulaState* workerState(int worker, unsigned int depth);
+    solverContext();
+    ~solverContext();
+} solverContext;
+
+//a batch: every (instance, algorithm) run of it, handed out to a fixed number
+//of threads longest-expected-first, and where the results go as they finish
+typedef struct batchRun {
+    vector<ssatInstance*> instances;
+    vector<solverContext*> jobs;
+    atomic<unsigned int> nextJob;
+    ostream* out;
+    bool json;
+    mutex outLock;
+    
+    void jobLoop();
+    void writeHeader();
+    void writeResult(solverContext &context);
+} batchRun;
 
 /***************************************************************************/
 /* globals variables */
-int maximumClauseLength;
-int minimumClauseLength;
-double averageClauseLength;
-int seed;
-int numVars;
-int numClauses;
-int numUCP;
-int numPVE;
-int numVS;
 double percentageVariableSplits;
 
-map <int, varInfo> variables; //starts indexing at 1
-map <int, set<int> > clauses; //starts indexing at 0
+//the shortcuts below change the UCP, PVE and VS counts, so they are off unless
+//asked for and a default run counts the nodes of the plain algorithms
+double cacheMegabytes = 0;      //memory cap of the formula cache, 0 for no cache
 
-bool UNSATclauseExists = false;  //indicate existence of unsatisfiable clause
+bool decomposeComponents = false;   //solve independent parts of the formula separately
+int componentMinVars = COMPONENT_MIN_VARS;
+int leafMaxVars = 0;            //solve formulas this small from their truth table, 0 to never
+bool bitsetEngine = true;       //search small instances with the bitset engine
+int heapMinVars = HEAP_MIN_VARS;    //blocks of at least this many variables keep their scores in a heap
+bool preprocessFormula = false; //simplify the clauses of every file before solving it
+
+//a subformula is only solved exactly if its probability is inside the window
+//(low, high) given by its parent. Outside of it, an upper bound <= low or a
+//lower bound >= high is returned instead, whichever side the probability is on
+bool branchAndBound = false;
+
+vector<double> thresholds;      //decide these instead of computing the probability, if any
+
+int numThreads = 1;             //threads of every run
+bool runConcurrently = true;    //run all algorithms at the same time, each on its own thread
+vector<unsigned int> algorithms = {NAIVE, UCPONLY, PVEONLY, UCPPVE, RANDOMVAR, MAXVAR, MINCLAUSE, MAXCLAUSE};
+
+int numJobs = max(1, (int)thread::hardware_concurrency());  //runs a batch keeps going at once
+string csvPath;                 //where a batch writes its results; stdout as csv if neither
+string jsonPath;                //is given
+
+int benchRuns = 5;              //timed runs of every benchmark job
+int benchWarmup = 1;            //untimed runs before them
+string benchOutPath;            //where the benchmark writes its results
+string comparePath;             //results of an earlier benchmark to compare with
+
+unsigned int randomSeed = DEFAULT_SEED; //seed of RANDOMVAR, the first one of a sweep
+int sweepSeeds = 0;             //RANDOMVAR runs of a sweep, one seed each
+
+#ifdef SSAT_STATS
+ofstream statsFile;             //a json record of every run goes here, if open
+mutex statsLock;
+bool perfEnabled = false;       //count hardware events too
+atomic<int> hwEventsOpened(0);  //bit i set if event i could be counted on some thread
+thread_local perfCounters threadCounters;
+thread_local unsigned long long heapAllocations = 0;    //operator new calls of the thread so far
+#endif
 
 /***************************************************************************/
 /* functions prototypes */
-double SOLVESSAT(const unsigned int &algorithm);
-void readFile(string input);
-void tokenize(string str, vector<string> &token_v);
-pair<bool, int> isPureChoice(int variable);
-
-void updateClausesAndVariables(int variable, int value,
-                               map<int, set<int> >* savedSATClausesPtr,
-                               vector<int>* savedFalseLiteralClausePtr,
-                               map<int, double>* savedInactiveVariables);
-void assign(int variable, int value);
-void undoChanges(int variable, int value, varInfo* savedInfo,
-                 map<int, set<int> >* savedSATClausesPtr,
-                 vector<int>* savedFalseLiteralClausePtr,
-                 map<int, double>* savedInactiveVariables);
-int unassigned_var();
-void printVariables();
-void printClauses();
-int randomSH();
-int maximumSH();
-vector<int> helperSH();
-void runAndPrintResult(int num, string name);
-void resetResult();
-int maxClause();
-int minClause();
-int largestClause(int variable);
-int smallestClause(int variable);
+double window(double bound);
+void initCache(formulaCache &cache, unsigned int keyWords, double megabytes);
+void growCache(formulaCache &cache);
+void runAlgorithm(solverContext* context);
+void writeStats(solverContext &context);
+bool readEvents(unsigned long long* values);
+void addEvents(unsigned long long* total, const unsigned long long* start, const unsigned long long* end);
+void printResult(solverContext &context, string name);
+bool parseAlgorithms(string list);
+vector<string> expandInputs(const vector<string> &patterns);
+bool runBatch(const vector<string> &patterns);
+bool runBench(string root);
+double percentile(vector<double> values, double fraction);
+bool readBenchFile(string path, vector<benchResult> &results);
+bool runSweep(const ssatInstance &instance);
+int literalCode(int literal);
+template <int words> solverKernel solverKernelFor(unsigned int algorithm);
 
 /*****************************************************************************
  Function:  main
@@ -124,865 +784,5547 @@ int smallestClause(int variable);
  *****************************************************************************/
 int main(int argc, char* argv[]) {
 
-    //open the file for reading
-    string input = argv[1];
-    readFile(input);
+    vector<string> inputs;
+    bool batch = false;
+    bool bench = false;
+    string convertPath;
+    
+    //options come before the file name
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--cache-mb" && i + 1 < argc) {
+            cacheMegabytes = atof(argv[++i]);
+        }
+        else if (arg == "--fast") {
+            //every shortcut at once, options after it can still change them
+            cacheMegabytes = DEFAULT_CACHE_MB;
+            decomposeComponents = true;
+            leafMaxVars = LEAF_MAX_VARS;
+            preprocessFormula = true;
+            branchAndBound = true;
+        }
+        else if (arg == "--components") {
+            decomposeComponents = true;
+        }
+        else if (arg == "--no-components") {
+            decomposeComponents = false;
+        }
+        else if (arg == "--component-min-vars" && i + 1 < argc) {
+            componentMinVars = atoi(argv[++i]);
+        }
+        else if (arg == "--leaf-vars" && i + 1 < argc) {
+            leafMaxVars = max(0, min(LEAF_VARS_LIMIT, atoi(argv[++i])));
+        }
+        else if (arg == "--heap-min-vars" && i + 1 < argc) {
+            heapMinVars = max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--no-bitset") {
+            bitsetEngine = false;
+        }
+        else if (arg == "--preprocess") {
+            preprocessFormula = true;
+        }
+        else if (arg == "--no-preprocess") {
+            preprocessFormula = false;
+        }
+        else if (arg == "--bounds") {
+            branchAndBound = true;
+        }
+        else if (arg == "--no-bounds") {
+            branchAndBound = false;
+        }
+        else if (arg == "--threshold" && i + 1 < argc) {
+            thresholds.push_back(atof(argv[++i]));
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            numThreads = max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--sequential") {
+            runConcurrently = false;
+        }
+        else if (arg == "--algorithms" && i + 1 < argc) {
+            if (!parseAlgorithms(argv[++i])) {
+                cout << "unknown algorithm in " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--batch") {
+            batch = true;
+        }
+        else if (arg == "--jobs" && i + 1 < argc) {
+            numJobs = max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--csv" && i + 1 < argc) {
+            csvPath = argv[++i];
+        }
+        else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        }
+        else if (arg == "--convert" && i + 1 < argc) {
+            convertPath = argv[++i];
+        }
+        else if (arg == "--bench") {
+            bench = true;
+        }
+        else if (arg == "--runs" && i + 1 < argc) {
+            benchRuns = max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--warmup" && i + 1 < argc) {
+            benchWarmup = max(0, atoi(argv[++i]));
+        }
+        else if (arg == "--bench-out" && i + 1 < argc) {
+            benchOutPath = argv[++i];
+        }
+        else if (arg == "--compare" && i + 1 < argc) {
+            comparePath = argv[++i];
+        }
+        else if (arg == "--seed" && i + 1 < argc) {
+            randomSeed = strtoul(argv[++i], NULL, 10);
+        }
+        else if (arg == "--sweep" && i + 1 < argc) {
+            sweepSeeds = max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--stats" && i + 1 < argc) {
+#ifdef SSAT_STATS
+            statsFile.open(argv[++i]);
+            if (!statsFile.is_open()) {
+                cout << "cannot write " << argv[i] << endl;
+                return 1;
+            }
+#else
+            cout << "--stats needs a build with SSAT_STATS (make ssat-stats)" << endl;
+            return 1;
+#endif
+        }
+        else if (arg == "--perf") {
+#ifdef SSAT_STATS
+            perfEnabled = true;
+#else
+            cout << "--perf needs a build with SSAT_STATS (make ssat-stats)" << endl;
+            return 1;
+#endif
+        }
+        else {
+            inputs.push_back(arg);
+        }
+    }
+    
+    if (bench && inputs.size() <= 1) {
+        return runBench(inputs.empty() ? "." : inputs[0]) ? 0 : 1;
+    }
+    
+    if (inputs.empty() || (!batch && inputs.size() > 1)) {
+        cout << "usage: ssat [--fast] [--cache-mb megabytes] [--components] [--component-min-vars n] [--leaf-vars n] [--heap-min-vars n] [--no-bitset] [--preprocess] [--bounds] [--threshold theta]... [--threads n] [--sequential] [--algorithms list] [--seed n] [file name]" << endl;
+        cout << "       ssat --sweep n [--seed first] [--jobs n] [options] [file name]" << endl;
+        cout << "       ssat --batch [--jobs n] [--csv file] [--json file] [options] [file, directory or glob]..." << endl;
+        cout << "       ssat --convert [.ssatb file] [file name]" << endl;
+        cout << "       ssat --bench [--runs n] [--warmup n] [--bench-out file] [--compare file] [options] [directory]" << endl;
+        return 1;
+    }
+    
+    if (batch) {
+        return runBatch(inputs) ? 0 : 1;
+    }
 
-    string names[] = {"NAIVE", "UCPONLY", "PVEONLY", "UCPPVE", "RANDOMVAR", "MAXVAR", "MINCLAUSE", "MAXCLAUSE"};
+    //a converted file holds the formula as it is, not as it would be solved
+    if (!convertPath.empty()) {
+        preprocessFormula = false;
+    }
+    
+    //open the file for reading
+    ssatInstance instance;
+    if (!instance.readFile(inputs[0])) {
+        cout << "File is not valid" << endl;
+        return 1;
+    }
+    cout << "File read successfully" << endl;
+    cout << "PARSE TIME: " << instance.parseTime << endl;
+    if (preprocessFormula) {
+        for (int s = 0; s < NUM_PREPROCESS_STEPS; s++) {
+            const preprocessStats &step = instance.preprocessSteps[s];
+            cout << "PREPROCESS " << PREPROCESS_NAMES[s] << ": " << step.clauses << " clauses and "
+                 << step.literals << " literals removed, TIME: " << step.seconds << endl;
+        }
+        cout << "CLAUSES AFTER PREPROCESS: " << instance.numClauses << " of " << instance.numClausesRead << endl;
+    }
+    
+    //or only write it in binary
+    if (!convertPath.empty()) {
+        if (!instance.writeBinary(convertPath)) {
+            cout << "cannot write " << convertPath << endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (sweepSeeds > 0) {
+        return runSweep(instance) ? 0 : 1;
+    }
+    
+    vector<solverContext*> contexts;
+    for (unsigned int i = 0; i < algorithms.size(); i++) {
+        contexts.push_back(new solverContext());
+        contexts[i]->instance = &instance;
+        contexts[i]->algorithm = algorithms[i];
+    }
     
     //run and print results of all algorithms, one at a time
-    for (unsigned int i = NAIVE; i <= MAXCLAUSE; i++) {
-        resetResult();
-        runAndPrintResult(i, names[i]);
+    if (!runConcurrently) {
+        for (unsigned int i = 0; i < contexts.size(); i++) {
+            contexts[i]->solve();
+            printResult(*contexts[i], ALGORITHM_NAMES[algorithms[i]]);
+        }
+        return 0;
+    }
+    
+    //or all at once, still printed in order
+    vector<thread> runs;
+    for (unsigned int i = 0; i < contexts.size(); i++) {
+        runs.push_back(thread(runAlgorithm, contexts[i]));
+    }
+    for (unsigned int i = 0; i < contexts.size(); i++) {
+        runs[i].join();
+        printResult(*contexts[i], ALGORITHM_NAMES[algorithms[i]]);
     }
     
     return 0;
 }
 
 /*****************************************************************************
- Function:  runAndPrintResult
- Inputs:    algorithm number and name of algorithm being run
+ Function:  parseAlgorithms
+ Inputs:    comma separated algorithm names
+ Returns:   false if a name is not one of ALGORITHM_NAMES
+ Description:   sets the algorithms to run, in the order given
+ *****************************************************************************/
+bool parseAlgorithms(string list) {
+
+    algorithms.clear();
+    stringstream names(list);
+    string name;
+    while (getline(names, name, ',')) {
+        unsigned int a = NAIVE;
+        while (a <= MAXCLAUSE && ALGORITHM_NAMES[a] != name) {
+            a++;
+        }
+        if (a > MAXCLAUSE) {
+            return false;
+        }
+        algorithms.push_back(a);
+    }
+    return !algorithms.empty();
+}
+
+/*****************************************************************************
+ Function:  runAlgorithm
+ Inputs:    context of the algorithm's run
  Returns:   nothing
- Description:   prints results of the corresponding algorithm to output window
+ Description:   body of the thread of one algorithm when they all run at once
  *****************************************************************************/
-void runAndPrintResult(int num, string name) {
+void runAlgorithm(solverContext* context) {
 
-    double start, end, solutionTime;
-    double allPossibleSplits = pow(2,numVars) - 1;
-    
-    start = clock();
-    cout << "====================================================================" << endl;
-    cout << "RESULT OF SOLVESSAT - " + name + ": " << SOLVESSAT(num) << endl;
-    cout << "NUM OF UCP: " << numUCP << endl;
-    cout << "NUM OF PVE: " << numPVE << endl;
-    cout << "NUM OF VS: " << numVS << endl;
-    cout << "PERCENTAGE OF VS: " << PERCENTAGE * (double)numVS/allPossibleSplits << endl;
-    end = clock();
-    solutionTime = double(end-start)/CLOCKS_PER_SEC;
-    cout << "SOLUTION TIME: " << solutionTime << endl;
-    cout << "====================================================================" << endl;
+    context->solve();
 }
 
-/***************************************************************************
- Function:  SOLVESSAT
- Inputs:    identifier of algorithm being run
- Returns:   double
- Description:   the main ssat algorithm implementation
- ***************************************************************************/
-double SOLVESSAT(const unsigned int &algorithm){
+/*****************************************************************************
+ Function:  solve
+ Inputs:    none
+ Returns:   nothing
+ Description:   runs the context's algorithm from the root and keeps the
+                result, the counters and the time it took
+ *****************************************************************************/
+void solverContext::solve() {
+
+    //wall time, so that a parallel search shows its gain
+    chrono::steady_clock::time_point start, end;
     
-    //returns success if all clauses have been satisfied
-    if (clauses.empty()) {
-        return SUCCESS;
+    start = chrono::steady_clock::now();
+    
+#ifdef SSAT_STATS
+    unsigned long long eventStart[NUM_HW_EVENTS], eventEnd[NUM_HW_EVENTS];
+    bool counting = perfEnabled && readEvents(eventStart);
+#endif
+    
+    //the bitset engine has no parallel search
+    int words = (bitsetEngine && numThreads == 1) ? instance->initialState->bitWords : 0;
+    bitset = (words > 0 && algorithm != RANDOMVAR);
+    switch (words) {
+        case 1:
+            kernel = solverKernelFor<1>(algorithm);
+            break;
+        case 2:
+            kernel = solverKernelFor<2>(algorithm);
+            break;
+        case 4:
+            kernel = solverKernelFor<4>(algorithm);
+            break;
+        default:
+            kernel = solverKernelFor<0>(algorithm);
+            break;
+    }
+    startWorkers();
+    formulaState* root = workerState(0, 0);
+    probSAT = FAILURE;
+    decisions.clear();
+#ifdef SSAT_STATS
+    unsigned long long allocationsStart = heapAllocations;
+#endif
+    if (thresholds.empty()) {
+        probSAT = (root->*kernel)(FAILURE, SUCCESS);
+    }
+    else {
+        decisions = root->decideSSAT(kernel, thresholds);
     }
     
-    //returns failure if there is at least one unsatisfiable clause OR there are 
-    //no more active variables while there are still active clauses
-    if (UNSATclauseExists || variables.empty() == true) {
-        return FAILURE;
+#ifdef SSAT_STATS
+    root->searchAllocations += heapAllocations - allocationsStart;
+    //the helper threads count their own in workerLoop
+    if (counting && readEvents(eventEnd)) {
+        addEvents(root->searchEvents, eventStart, eventEnd);
     }
+#endif
     
-    //[START] setting up the structures needed to save information that are being updated
-
-    //struct to store the information of the variables: its quantifier and its clauseMember map
-    // being considered
-    varInfo savedInfo;
-
-    //map of all clauses that are satisfied under the assignment
-    map<int, set <int> > savedSATClauses;
-
-    //vector of clause numbers whose currently assigned variable appear false
-    vector<int> savedFalseLiteralClause;
-
-    //map of all variables that become inactive after their clauseMember map is updated
-    //after the assignment
-    map<int, double> savedInactiveVariables;
-
-    //[END] setting up
+    stopWorkers();
+    
+    end = chrono::steady_clock::now();
+    solutionTime = chrono::duration<double>(end - start).count();
     
-    //v - variable being considered
-    int v = 0;
+#ifdef SSAT_STATS
+    writeStats(*this);
+#endif
+}
 
-    //value - value to be assigned to v
-    int value = 0;
+/*****************************************************************************
+ Function:  writeStats
+ Inputs:    context of a finished run
+ Returns:   nothing
+ Description:   writes one json line about the run to the --stats file: the
+                time spent in every phase (summed over threads), the nodes
+                per second, the nodes at every depth (variables gone from the
+                formula) and the peak memory of the process so far. Only
+                built with SSAT_STATS
+ *****************************************************************************/
+void writeStats(solverContext &context) {
+#ifdef SSAT_STATS
+    if (!statsFile.is_open()) {
+        return;
+    }
     
-    //BEGIN UNIT CLAUSES PROPAGATION
-    if (algorithm == UCPONLY || algorithm >= UCPPVE) {
-        for (map<int, set<int> >::iterator it = clauses.begin(); it != clauses.end(); it++) {
-            
-            if (it->second.size() == UNIT_SIZE) {
-                
-                //updating total number of UCP
-                ++numUCP;       
-                
-                //assigning the required value for v
-                value = POSITIVE;
-                set<int>::iterator se = it->second.begin();
-                v = *se;
-                
-                //make sure that the value matches with its quantifier
-                if (v < 0) {
-                    value = NEGATIVE;
-                    v *= NEGATIVE;
-                }
-                
-                //save the info of assigned variable v
-                savedInfo.quantifier = variables[v].quantifier;
-                savedInfo.clauseMembers = variables[v].clauseMembers;
-                
-                //the below part resemebles the algorithm distributed by professor Majercik
-                updateClausesAndVariables(v, value, &savedSATClauses, &savedFalseLiteralClause, &savedInactiveVariables);
-                
-                double probSAT = SOLVESSAT(algorithm);
-                
-                undoChanges(v, value, &savedInfo, &savedSATClauses, &savedFalseLiteralClause, &savedInactiveVariables);
-                
-                if (variables[v].quantifier == CHOICE_VALUE) {
-                    return probSAT;
-                }
-                
-                if (value == NEGATIVE) {
-                    return probSAT * (1 - variables[v].quantifier);
+    const searchCounters &totals = context.totals;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    
+    lock_guard<mutex> guard(statsLock);
+    
+    statsFile << setprecision(15) << "{\"file\": \"" << context.instance->name
+              << "\", \"algorithm\": \"" << ALGORITHM_NAMES[context.algorithm]
+              << "\", \"threads\": " << numThreads << ", \"time\": " << context.solutionTime
+              << ", \"nodes\": " << totals.numNodes
+              << ", \"nodes_per_second\": " << totals.numNodes / max(context.solutionTime, 1e-9)
+              << ", \"ucp\": " << totals.numUCP << ", \"pve\": " << totals.numPVE
+              << ", \"vs\": " << totals.numVS << ", \"clauses_read\": " << context.instance->numClausesRead
+              << ", \"clauses\": " << context.instance->numClauses << ", \"preprocess\": {";
+    for (int s = 0; s < NUM_PREPROCESS_STEPS; s++) {
+        const preprocessStats &step = context.instance->preprocessSteps[s];
+        statsFile << (s ? ", " : "") << "\"" << PREPROCESS_NAMES[s] << "\": {\"seconds\": " << step.seconds
+                  << ", \"clauses\": " << step.clauses << ", \"literals\": " << step.literals << "}";
+    }
+    statsFile << "}, \"phases\": {";
+    for (int p = 0; p < NUM_PHASES; p++) {
+        statsFile << (p ? ", " : "") << "\"" << PHASE_NAMES[p] << "\": {\"seconds\": "
+                  << totals.phaseNanos[p] * 1e-9 << ", \"calls\": " << totals.phaseCalls[p] << "}";
+    }
+    statsFile << "}, \"depth_histogram\": [";
+    for (unsigned int d = 0; d < totals.depthHistogram.size(); d++) {
+        statsFile << (d ? ", " : "") << totals.depthHistogram[d];
+    }
+    
+    //kilobytes on linux
+    statsFile << "], \"peak_rss_kb\": " << usage.ru_maxrss;
+    statsFile << ", \"heap_allocations\": " << totals.searchAllocations
+              << ", \"heap_allocations_per_node\": " << (double)totals.searchAllocations / max(totals.numNodes, 1LL);
+    
+    //hardware events, also per node; null for the events that could not be counted
+    if (perfEnabled) {
+        int opened = hwEventsOpened;
+        statsFile << ", \"perf\": {\"available\": " << (opened ? "true" : "false");
+        if (opened) {
+            const unsigned long long* counts[NUM_PHASES + 2];
+            string names[NUM_PHASES + 2];
+            counts[0] = context.instance->parseEvents;
+            names[0] = "parse";
+            counts[1] = totals.searchEvents;
+            names[1] = "search";
+            for (int p = 0; p < NUM_PHASES; p++) {
+                counts[p + 2] = totals.phaseEvents[p];
+                names[p + 2] = PHASE_NAMES[p];
+            }
+            for (int g = 0; g < NUM_PHASES + 2; g++) {
+                statsFile << ", \"" << names[g] << "\": {";
+                for (int e = 0; e < NUM_HW_EVENTS; e++) {
+                    statsFile << (e ? ", " : "") << "\"" << HW_EVENT_NAMES[e] << "\": ";
+                    bool counted = opened & (1 << e);
+                    if (counted) {
+                        statsFile << counts[g][e];
+                    }
+                    else {
+                        statsFile << "null";
+                    }
+                    
+                    //the file is parsed once, not per node
+                    if (g > 0) {
+                        statsFile << ", \"" << HW_EVENT_NAMES[e] << "_per_node\": ";
+                        if (counted) {
+                            statsFile << (double)counts[g][e] / max(totals.numNodes, 1LL);
+                        }
+                        else {
+                            statsFile << "null";
+                        }
+                    }
                 }
-                
-                return probSAT * variables[v].quantifier;
+                statsFile << "}";
             }
         }
+        statsFile << "}";
     }
-    //END UNIT CLAUSES PROPAGATION
-    
-    //BEGIN PURE CHOICE ELIMINATION
-
-    //stores the return from isPureChoice function
-    pair<bool, int> result;     
-    
-    if (algorithm >= PVEONLY) {
+    statsFile << "}" << endl;
+#else
+    (void)context;
+#endif
+}
 
-        //going through every key in the variables map to find the first pure choice variable
-        for (map<int, varInfo>::iterator it = variables.begin(); it != variables.end(); it++){
-            
-            result = isPureChoice(it->first);
+/*****************************************************************************
+ Function:  printResult
+ Inputs:    context of a finished run and name of its algorithm
+ Returns:   nothing
+ Description:   prints results of the corresponding algorithm to output window
+ *****************************************************************************/
+void printResult(solverContext &context, string name) {
 
-            //store the being considered variable in variable v
-            v = it->first;
+    double allPossibleSplits = pow(2,context.instance->numVars) - 1;
+    const searchCounters &totals = context.totals;
+    const vector<thresholdDecision> &decisions = context.decisions;
+    
+    cout << "====================================================================" << endl;
+    if (thresholds.empty()) {
+        cout << "RESULT OF SOLVESSAT - " + name + ": " << context.probSAT << endl;
+    }
+    for (unsigned int t = 0; t < decisions.size(); t++) {
+        cout << "RESULT OF SOLVESSAT - " + name + " >= " << decisions[t].threshold << ": "
+             << (decisions[t].satisfied ? "YES" : "NO") << endl;
+        cout << "BOUNDS: [" << decisions[t].lower << ", " << decisions[t].upper << "]" << endl;
+    }
+    if (context.algorithm == RANDOMVAR) {
+        cout << "SEED: " << context.seed << endl;
+    }
+    
+    //what the counters below include besides the algorithm's own search
+    string shortcuts;
+    if (preprocessFormula) {
+        shortcuts += ", preprocess";
+    }
+    if (cacheMegabytes > 0) {
+        shortcuts += ", cache";
+    }
+    if (decomposeComponents) {
+        shortcuts += ", components";
+    }
+    if (branchAndBound) {
+        shortcuts += ", bounds";
+    }
+    if (leafMaxVars > 0) {
+        shortcuts += ", leaf solves (" + to_string(leafMaxVars) + " vars)";
+    }
+    if (context.bitset) {
+        shortcuts += ", bitset engine";
+    }
+    cout << "SHORTCUTS: " << (shortcuts.empty() ? "none" : shortcuts.substr(2)) << endl;
+    cout << "NUM OF UCP: " << totals.numUCP << endl;
+    cout << "NUM OF PVE: " << totals.numPVE << endl;
+    cout << "NUM OF VS: " << totals.numVS << endl;
+    cout << "PERCENTAGE OF VS: " << PERCENTAGE * (double)totals.numVS/allPossibleSplits << endl;
+    cout << "NUM OF CACHE HITS: " << totals.numCacheHits << endl;
+    cout << "NUM OF CACHE MISSES: " << totals.numCacheMisses << endl;
+    cout << "NUM OF COMPONENT SPLITS: " << totals.numComponentSplits << endl;
+    cout << "NUM OF CHOICE PRUNES: " << totals.numChoicePrunes << endl;
+    cout << "NUM OF CHANCE LOWER PRUNES: " << totals.numChanceLowerPrunes << endl;
+    cout << "NUM OF CHANCE UPPER PRUNES: " << totals.numChanceUpperPrunes << endl;
+    cout << "NUM OF COMPONENT PRUNES: " << totals.numComponentPrunes << endl;
+    cout << "NUM OF LEAF SOLVES: " << totals.numLeafSolves << endl;
+    if (numThreads > 1) {
+        cout << "NUM OF STOLEN SUBTREES: " << totals.numStolenTasks << endl;
+        for (int w = 0; w < numThreads; w++) {
+            cout << "NUM OF NODES ON THREAD " << w << ": " << context.threadNodes[w] << endl;
+        }
+    }
+    cout << "SOLUTION TIME: " << context.solutionTime << endl;
+    cout << "====================================================================" << endl;
+}
 
-            //if there is no pure choice variable then continue
-            if (result.first == false) {
-                continue;
-            }
-            
-            //found a pure choice variable, execute PVE and return computed probability, ending the above 
-            // for-loop
-            else {
-                
-                //updating total number of PVE
-                ++numPVE;       
-                
-                //save the info of assigned variable v
-                savedInfo.quantifier = variables[v].quantifier;
-                savedInfo.clauseMembers = variables[v].clauseMembers;
+/***************************************************************************
+ Function:  solverKernelFor
+ Inputs:    words of a variable mask of the bitset engine (template, 0 for
+            the clause arena), algorithm
+ Returns:   the search of the algorithm on that engine
+ Description:   a new algorithm is a new policy here and a name in
+                ALGORITHM_NAMES. RANDOMVAR picks from the order of the
+                arena's block index, so it always runs on the arena
+ ***************************************************************************/
+template <int words>
+solverKernel solverKernelFor(unsigned int algorithm) {
 
-                //set the value of v
-                value = result.second;
-                
-                //the below part resemebles the algorithm distributed by professor Majercik
-                updateClausesAndVariables(v, value, &savedSATClauses, &savedFalseLiteralClause, &savedInactiveVariables);
-                
-                double probSSAT = SOLVESSAT(algorithm);
-                
-                undoChanges(v, value, &savedInfo, &savedSATClauses, &savedFalseLiteralClause, &savedInactiveVariables);
-                
-                return probSSAT;
-            }
-        }
+    switch (algorithm) {
+        case NAIVE:
+            return &formulaState::SOLVESSAT<searchPolicy<false, false, SPLIT_FIRST, words> >;
+        case UCPONLY:
+            return &formulaState::SOLVESSAT<searchPolicy<true, false, SPLIT_FIRST, words> >;
+        case PVEONLY:
+            return &formulaState::SOLVESSAT<searchPolicy<false, true, SPLIT_FIRST, words> >;
+        case UCPPVE:
+            return &formulaState::SOLVESSAT<searchPolicy<true, true, SPLIT_FIRST, words> >;
+        case RANDOMVAR:
+            return &formulaState::SOLVESSAT<searchPolicy<true, true, SPLIT_RANDOM, 0> >;
+        default:
+            return &formulaState::SOLVESSAT<searchPolicy<true, true, SPLIT_SCORED, words> >;
     }
-    //END PURE CHOICE ELIMINATION
-    
-    //BEGIN VARIABLE SPLITS
+}
 
-    //choosing the right heuristic to run based on the "algorithm" variable
-    if (algorithm <= UCPPVE) {
-        v = unassigned_var();
-    } 
-    else {
-        switch (algorithm){
-            case RANDOMVAR:
-                v = randomSH();
+/***************************************************************************
+ Function:  SOLVESSAT
+ Inputs:    policy of the algorithm being run (template), window of
+            interesting values
+ Returns:   double
+ Description:   the main ssat algorithm implementation. Every subformula is
+                a frame on the state's frame stack instead of a call on the
+                native stack: a frame that needs the value of a branch or a
+                component pushes it and is resumed at its stage once that is
+                solved, with the value. The result is exact if it is inside
+                (low, high), a bound otherwise
+ ***************************************************************************/
+template <class policy>
+double formulaState::SOLVESSAT(double low, double high){
+    
+    //frames below this are searches this call is part of
+    unsigned int bottom = frames.size();
+    pushFrame(low, high);
+    
+    //value of the frame that was solved last
+    double probability = FAILURE;
+    
+    while (frames.size() > bottom) {
+        
+        //a frame that pushes another one returns right after, so the reference
+        //is never used once the stack has grown
+        searchFrame &frame = frames.back();
+        bool solved;
+        switch (frame.stage) {
+            case STAGE_ENTER:
+                solved = enterFormula<policy>(frame, &probability);
                 break;
-            case MAXVAR:
-                v = maximumSH();
+            case STAGE_COMPONENT:
+                solved = resumeComponents<policy>(frame, &probability);
                 break;
-            case MINCLAUSE:
-                v = minClause();
+            case STAGE_FALSE_BRANCH:
+                solved = resumeFalseBranch<policy>(frame, &probability);
                 break;
             default:
-                v = maxClause();
+                solved = resumeTrueBranch<policy>(frame, &probability);
                 break;
         }
+        
+        if (solved) {
+            probability = leaveFormula<policy>(frame, probability);
+            frames.pop_back();
+        }
     }
     
-    if (v == INVALID) {
-        cout << "The variable is invalid" << endl;
-        return FAILURE;
-    }
-    
-    //updating total number of variable splits (VS)
-    ++numVS;        
+    return probability;
+}
 
-    //[BEGIN] try setting v to FALSE
-    value = NEGATIVE;
-    
-    //save info of assigned variable v
-    savedInfo.quantifier = variables[v].quantifier;
-    savedInfo.clauseMembers = variables[v].clauseMembers;
+/***************************************************************************
+ Function:  pushFrame
+ Inputs:    window of interesting values
+ Returns:   none
+ Description:   puts the current formula on the frame stack, to be entered
+                by SOLVESSAT next
+ ***************************************************************************/
+void formulaState::pushFrame(double low, double high) {
+
+    frames.push_back(searchFrame());
+    searchFrame &frame = frames.back();
+    frame.low = low;
+    frame.high = high;
+    frame.stage = STAGE_ENTER;
+    frame.cached = false;
+    frame.task = NULL;
+}
+
+/***************************************************************************
+ Function:  leaveFormula
+ Inputs:    policy of the algorithm being run (template), frame that was
+            just solved and its probability
+ Returns:   the probability
+ Description:   stores the frame's formula in the cache if it was looked up
+                there. The formula is back to the same state once it is
+                solved, so its key can be used again to store it
+ ***************************************************************************/
+template <class policy>
+double formulaState::leaveFormula(searchFrame &frame, double probability) {
+
+    if (!frame.cached) {
+        return probability;
+    }
     
-    //the below part resemebles the algorithm distributed by professor Majercik
-    updateClausesAndVariables(v, value, &savedSATClauses, &savedFalseLiteralClause, &savedInactiveVariables);
+    //without a prune or a cached bound below, the result is exact even if it is outside the window
+    int bound = CACHE_EXACT;
+    if (numInexact() != frame.boundsBefore) {
+        if (probability <= frame.low) {
+            bound = CACHE_UPPER;
+        }
+        else if (probability >= frame.high) {
+            bound = CACHE_LOWER;
+        }
+    }
+    if (policy::words) {
+        bitSyncKey<policy::words>();
+    }
+    storeCache(probability, bound, numVS - frame.splitsBefore);
     
-    double probSATWithFalse = SOLVESSAT(algorithm);
+    return probability;
+}
+
+/***************************************************************************
+ Function:  decideSSAT
+ Inputs:    search of the algorithm being run, thresholds in any order
+ Returns:   the decision for every threshold, in the same order
+ Description:   decides whether the probability of satisfaction is at least
+                each threshold, searching only until the bounds settle it.
+                The window just below the threshold up to the threshold is
+                empty, so every result is a bound on one side of it. The
+                interval found so far is kept from one threshold to the next
+                (as are cached bounds), and a threshold it already settles
+                takes no search at all
+ ***************************************************************************/
+vector<thresholdDecision> formulaState::decideSSAT(solverKernel kernel, const vector<double> &thresholds) {
+
+    vector<thresholdDecision> decisions;
+    double lower = FAILURE;
+    double upper = SUCCESS;
     
-    undoChanges(v, value, &savedInfo, &savedSATClauses, &savedFalseLiteralClause, &savedInactiveVariables);
+    for (unsigned int t = 0; t < thresholds.size(); t++) {
+        double theta = thresholds[t];
+        
+        if (theta > lower && theta <= upper) {
+            int boundsBefore = numInexact();
+            double probSAT = (this->*kernel)(window(nextafter(theta, -HUGE_VAL)), window(theta));
+            
+            //without pruning the search ran to the end and the value is exact
+            if (!branchAndBound || numInexact() == boundsBefore) {
+                lower = upper = probSAT;
+            }
+            else if (probSAT >= theta) {
+                lower = max(lower, probSAT);
+            }
+            else {
+                upper = min(upper, probSAT);
+            }
+        }
+        
+        thresholdDecision decision;
+        decision.threshold = theta;
+        decision.satisfied = lower >= theta;
+        decision.lower = lower;
+        decision.upper = upper;
+        decisions.push_back(decision);
+    }
     
-    //[END] try setting v to FALSE
+    return decisions;
+}
+
+/***************************************************************************
+ Function:  enterFormula
+ Inputs:    policy of the algorithm being run (template), frame of the
+            current formula, where to write its probability
+ Returns:   true if the formula is solved, false if the frame pushed the
+            first of its components or branches
+ Description:   formulas that were already solved in this run are taken
+                from the cache. Any other formula, which is neither
+                satisfied nor unsatisfiable yet, goes through unit
+                propagation, pure choice elimination, the leaf solver and
+                component decomposition, and then a split on one variable
+                whose FALSE branch is pushed first
+ ***************************************************************************/
+template <class policy>
+bool formulaState::enterFormula(searchFrame &frame, double* probability) {
+
+    //returns success if all clauses have been satisfied
+    if (numActiveClauses == 0) {
+        *probability = SUCCESS;
+        return true;
+    }
+    
+    //returns failure if there is at least one unsatisfiable clause OR there are 
+    //no more active variables while there are still active clauses
+    if (UNSATclauseExists || numActiveVars == 0) {
+        *probability = FAILURE;
+        return true;
+    }
+    
+    if (cache->maxSlots != 0) {
+        
+        //the bitset engine builds the key only when it is needed
+        if (policy::words) {
+            bitSyncKey<policy::words>();
+        }
+        if (lookupCache(frame.low, frame.high, probability)) {
+            ++numCacheHits;
+            return true;
+        }
+        ++numCacheMisses;
+        frame.cached = true;
+        frame.splitsBefore = numVS;
+        frame.boundsBefore = numInexact();
+    }
+    
+    ++numNodes;
+#ifdef SSAT_STATS
+    unsigned int eliminated = numVars - numActiveVars;
+    if (depthHistogram.size() <= eliminated) {
+        depthHistogram.resize(numVars + 1, 0);
+    }
+    depthHistogram[eliminated]++;
+#endif
+    
+    //every change made below this node is recorded on the trail after this point
+    frame.level = trail.size();
+    
+    //product of the chance probabilities of the variables set by unit propagation
+    frame.unitProbability = SUCCESS;
+    
+    //BEGIN UNIT CLAUSES PROPAGATION
+    if (policy::propagate) {
+        
+        //the whole chain of units is propagated here instead of one unit per call
+        frame.unitProbability = policy::words ? bitPropagate<policy::words>() : propagateUnits();
+        
+        //same checks as on entry, for the formula left after propagation
+        if (numActiveClauses == 0) {
+            undoTo<policy>(frame.level);
+            *probability = frame.unitProbability;
+            return true;
+        }
+        if (UNSATclauseExists || numActiveVars == 0) {
+            undoTo<policy>(frame.level);
+            *probability = FAILURE;
+            return true;
+        }
+    }
+    //END UNIT CLAUSES PROPAGATION
+    
+    //BEGIN PURE CHOICE ELIMINATION
+    if (policy::eliminate) {
+        
+        //every pure choice variable is set here instead of one per call
+        if (policy::words) {
+            bitEliminate<policy::words>();
+        }
+        else {
+            eliminatePureChoices();
+        }
+        
+        //same checks as on entry, for the formula left after elimination
+        if (numActiveClauses == 0) {
+            undoTo<policy>(frame.level);
+            *probability = frame.unitProbability;
+            return true;
+        }
+        if (UNSATclauseExists || numActiveVars == 0) {
+            undoTo<policy>(frame.level);
+            *probability = FAILURE;
+            return true;
+        }
+    }
+    //END PURE CHOICE ELIMINATION
+    
+    //the branches below only undo their own changes, not the propagated units
+    //and eliminated pure variables
+    frame.branchLevel = trail.size();
+    
+    //the window of the formula left, before it is multiplied by unitProbability
+    frame.lower = -HUGE_VAL;
+    frame.upper = HUGE_VAL;
+    if (frame.unitProbability > FAILURE) {
+        frame.lower = frame.low / frame.unitProbability;
+        frame.upper = frame.high / frame.unitProbability;
+    }
+    
+    //BEGIN LEAF SOLVE
+    if (numActiveVars <= leafMaxVars) {
+        double probSAT = policy::words ? bitLeaf<policy::words>() : solveLeaf();
+        undoTo<policy>(frame.level);
+        *probability = probSAT * frame.unitProbability;
+        return true;
+    }
+    //END LEAF SOLVE
+    
+    //BEGIN COMPONENT DECOMPOSITION
+    if (decomposeComponents && numActiveVars >= componentMinVars &&
+        (policy::words ? bitFindComponents<policy::words>(frame) : findComponents(frame))) {
+        
+        frame.product = SUCCESS;
+        frame.component = 0;
+        openComponent<policy>(frame);
+        return false;
+    }
+    //END COMPONENT DECOMPOSITION
+    
+    //BEGIN VARIABLE SPLITS
+
+    //choosing the right heuristic to run based on the policy
+    int v;
+    {
+        STATS_PHASE(PHASE_HEURISTIC);
+        switch (policy::heuristic){
+            case SPLIT_FIRST:
+                v = policy::words ? bitFirstVar<policy::words>() : unassigned_var();
+                break;
+            case SPLIT_RANDOM:
+                v = randomSH();
+                break;
+            default:
+                v = policy::words ? bitScoredVar<policy::words>() : scoredSH();
+                break;
+        }
+    }
+    
+    if (v == INVALID) {
+        cout << "The variable is invalid" << endl;
+        undoTo<policy>(frame.level);
+        *probability = FAILURE;
+        return true;
+    }
+    
+    //updating total number of variable splits (VS)
+    ++numVS;
+    frame.variable = v;
+    
+    //window of the FALSE branch: a choice node takes it as it is, a chance node
+    //needs it wide enough that the TRUE branch (worth 0 to 1) can still matter
+    double probTrue = quantifier[v];
+    double probFalse = 1 - probTrue;
+    frame.childLower = frame.lower;
+    frame.childUpper = frame.upper;
+    if (probTrue != CHOICE_VALUE) {
+        frame.childLower = probFalse > FAILURE ? (frame.lower - probTrue) / probFalse : -HUGE_VAL;
+        frame.childUpper = probFalse > FAILURE ? frame.upper / probFalse : HUGE_VAL;
+    }
+    
+    //[BEGIN] offer the TRUE branch to idle threads
     
-    //[BEGIN] try setting v to TRUE
-    value = POSITIVE;
+    //its window cannot depend on the FALSE branch, which is not solved yet
+    frame.stolenLower = frame.lower;
+    frame.stolenUpper = frame.upper;
+    if (policy::words == 0 && numThreads > 1 && numActiveVars >= TASK_MIN_VARS && context->numOpenTasks < context->numIdleWorkers) {
+        if (probTrue != CHOICE_VALUE) {
+            frame.stolenLower = probTrue > FAILURE ? (frame.lower - probFalse) / probTrue : -HUGE_VAL;
+            frame.stolenUpper = probTrue > FAILURE ? frame.upper / probTrue : HUGE_VAL;
+        }
+        frame.task = offerTask(v, window(frame.stolenLower), window(frame.stolenUpper));
+    }
+    
+    //[END] offer the TRUE branch to idle threads
+
+    //[BEGIN] try setting v to FALSE
     
-    //save info of assigned variable v
-    savedInfo.quantifier = variables[v].quantifier;
-    savedInfo.clauseMembers = variables[v].clauseMembers;
+    //units and pure variables left over from this node were either used or are not wanted
+    clearQueues();
     
     //the below part resemebles the algorithm distributed by professor Majercik
-    updateClausesAndVariables(v, value, &savedSATClauses, &savedFalseLiteralClause, &savedInactiveVariables);
+    setVariable<policy>(v, NEGATIVE);
+    
+    frame.stage = STAGE_FALSE_BRANCH;
+    pushFrame(window(frame.childLower), window(frame.childUpper));
+    return false;
+}
+
+/***************************************************************************
+ Function:  resumeFalseBranch
+ Inputs:    policy of the algorithm being run (template), frame of the
+            split, where the FALSE branch's probability is and where to
+            write the frame's
+ Returns:   true if the split is solved, false if it pushed its TRUE branch
+ Description:   the TRUE branch is skipped if no value of it can bring the
+                result into the window, and is taken from the thread that
+                stole it if it was offered and taken
+ ***************************************************************************/
+template <class policy>
+bool formulaState::resumeFalseBranch(searchFrame &frame, double* probability) {
+
+    undoTo<policy>(frame.branchLevel);
     
-    double probSATWithTrue = SOLVESSAT(algorithm);
+    //[END] try setting v to FALSE
     
-    undoChanges(v, value, &savedInfo, &savedSATClauses, &savedFalseLiteralClause, &savedInactiveVariables);
+    double probSATWithFalse = *probability;
+    frame.falseValue = probSATWithFalse;
+    double probTrue = quantifier[frame.variable];
+    double probFalse = 1 - probTrue;
+    double lower = frame.lower;
+    double upper = frame.upper;
+    double probSAT;
     
-    //[END] try setting v to TRUE
+    //[BEGIN] try setting v to TRUE, unless its value cannot change the result
+    if (frame.task != NULL && !reclaimTask(frame.task)) {
+        
+        //another thread solved it, with the window it was offered with
+        double probSATWithTrue = joinTask(frame.task);
+        
+        //the below part resemebles the algorithm distributed by professor Majercik
+        if (probTrue == CHOICE_VALUE) {
+            probSAT = max(probSATWithFalse, probSATWithTrue);
+        }
+        else {
+            probSAT = probSATWithFalse * probFalse + probSATWithTrue * probTrue;
+            
+            //either branch alone can put the node outside its window
+            if (branchAndBound && (probSATWithFalse <= frame.childLower || probSATWithTrue <= frame.stolenLower)) {
+                probSAT = min(probSAT, lower);
+            }
+            else if (branchAndBound && (probSATWithFalse >= frame.childUpper || probSATWithTrue >= frame.stolenUpper)) {
+                probSAT = max(probSAT, upper);
+            }
+        }
+    }
+    else if (probTrue == CHOICE_VALUE) {
+        if (branchAndBound && (probSATWithFalse >= upper || probSATWithFalse >= SUCCESS)) {
+            ++numChoicePrunes;
+            probSAT = probSATWithFalse;
+        }
+        else {
+            clearQueues();
+            
+            //the below part resemebles the algorithm distributed by professor Majercik
+            setVariable<policy>(frame.variable, POSITIVE);
+            
+            //only a value above the FALSE branch is of any use
+            frame.childLower = max(lower, probSATWithFalse);
+            frame.childUpper = upper;
+            frame.stage = STAGE_TRUE_BRANCH;
+            pushFrame(window(frame.childLower), window(frame.childUpper));
+            return false;
+        }
+    }
+    else if (branchAndBound && probSATWithFalse <= frame.childLower) {
+        
+        //even if the TRUE branch is satisfied for sure, the node stays below its window
+        ++numChanceLowerPrunes;
+        probSAT = min(probSATWithFalse * probFalse + probTrue, lower);
+    }
+    else if (branchAndBound && probSATWithFalse >= frame.childUpper) {
+        
+        //even if the TRUE branch fails for sure, the node is above its window
+        ++numChanceUpperPrunes;
+        probSAT = max(probSATWithFalse * probFalse, upper);
+    }
+    else {
+        clearQueues();
+        
+        //the below part resemebles the algorithm distributed by professor Majercik
+        setVariable<policy>(frame.variable, POSITIVE);
+        
+        frame.childLower = -HUGE_VAL;
+        frame.childUpper = HUGE_VAL;
+        if (probTrue > FAILURE) {
+            frame.childLower = (lower - probSATWithFalse * probFalse) / probTrue;
+            frame.childUpper = (upper - probSATWithFalse * probFalse) / probTrue;
+        }
+        frame.stage = STAGE_TRUE_BRANCH;
+        pushFrame(window(frame.childLower), window(frame.childUpper));
+        return false;
+    }
+    
+    *probability = finishSplit<policy>(frame, probSAT);
+    return true;
+}
+
+/***************************************************************************
+ Function:  resumeTrueBranch
+ Inputs:    policy of the algorithm being run (template), frame of the
+            split, where the TRUE branch's probability is and where to
+            write the frame's
+ Returns:   true, the split is solved
+ Description:   combines the values of both branches
+ ***************************************************************************/
+template <class policy>
+bool formulaState::resumeTrueBranch(searchFrame &frame, double* probability) {
+
+    undoTo<policy>(frame.branchLevel);
+    
+    double probSATWithFalse = frame.falseValue;
+    double probSATWithTrue = *probability;
+    double probTrue = quantifier[frame.variable];
+    double probSAT;
     
     //the below part resemebles the algorithm distributed by professor Majercik
-    if (variables[v].quantifier == CHOICE_VALUE) {
-        return max(probSATWithFalse, probSATWithTrue);
+    if (probTrue == CHOICE_VALUE) {
+        probSAT = max(probSATWithFalse, probSATWithTrue);
+    }
+    else {
+        probSAT = probSATWithFalse * (1 - probTrue) + probSATWithTrue * probTrue;
+        
+        //a bound of the TRUE branch is a bound of the node on the same side
+        if (branchAndBound && probSATWithTrue <= frame.childLower) {
+            probSAT = min(probSAT, frame.lower);
+        }
+        else if (branchAndBound && probSATWithTrue >= frame.childUpper) {
+            probSAT = max(probSAT, frame.upper);
+        }
+    }
+    
+    //[END] try setting v to TRUE
+    
+    *probability = finishSplit<policy>(frame, probSAT);
+    return true;
+}
+
+/***************************************************************************
+ Function:  finishSplit
+ Inputs:    policy of the algorithm being run (template), frame of the
+            split, probability of the formula left after its units
+ Returns:   probability of the frame's formula
+ Description:   undoes the frame's units and pure variables, gives back the
+                task it offered and keeps a bound on the right side of the
+                window after rounding
+ ***************************************************************************/
+template <class policy>
+double formulaState::finishSplit(searchFrame &frame, double probSAT) {
+
+    undoTo<policy>(frame.level);
+    if (frame.task != NULL) {
+        releaseTask();
+        frame.task = NULL;
+    }
+    
+    if (branchAndBound && probSAT <= frame.lower) {
+        return min(probSAT * frame.unitProbability, frame.low);
+    }
+    if (branchAndBound && probSAT >= frame.upper) {
+        return max(probSAT * frame.unitProbability, frame.high);
     }
     
-    return probSATWithFalse * (1 - variables[v].quantifier) + probSATWithTrue * variables[v].quantifier;
+    return probSAT * frame.unitProbability;
     
     //END VARIABLE SPLITS
 }
 
 /***************************************************************************
- Function:  updateClausesAndVariables
- Inputs:    structures keeping track of changing data
+ Function:  openComponent
+ Inputs:    policy of the algorithm being run (template), frame whose
+            components were found
  Returns:   none
- Description:   remove all satisfactory clauses after a given assignment
-                update the clauseMembers of affected variables
+ Description:   sets aside every clause and variable that is not in the
+                frame's current component and pushes that component. The
+                components left are worth at most 1, so this one has to be
+                above low / product
  ***************************************************************************/
-void updateClausesAndVariables(int variable, int value,
-                               map<int, set<int> >* savedSATClausesPtr,
-                               vector<int>* savedFalseLiteralClausePtr,
-                               map<int, double>* savedInactiveVariables) {
+template <class policy>
+void formulaState::openComponent(searchFrame &frame) {
+
+    if (policy::words) {
+        bitEnterComponent<policy::words>(frame);
+    }
+    else {
+        enterComponent(frame);
+    }
+    
+    clearQueues();
+    
+    frame.childLower = frame.lower / frame.product;
+    frame.stage = STAGE_COMPONENT;
+    pushFrame(window(frame.childLower), SUCCESS);
+}
 
-    //create pointer to varInfo struct of assigned variable
-    varInfo* info = &(variables[variable]);
+/***************************************************************************
+ Function:  resumeComponents
+ Inputs:    policy of the algorithm being run (template), frame whose
+            current component was just solved, where that component's
+            probability is and where to write the frame's
+ Returns:   true if the formula is solved, false if it pushed its next
+            component
+ Description:   the probability is the product of the components'. Once the
+                product is at or below the window the other components
+                cannot lift it, and it is an upper bound
+ ***************************************************************************/
+template <class policy>
+bool formulaState::resumeComponents(searchFrame &frame, double* probability) {
 
-    //create pointer to clauseMember map (in varInfo struct) of assigned variable
-    map<int, int>* clauseSet = &((*info).clauseMembers);
+    double probComponent = *probability;
+    frame.product *= probComponent;
+    undoTo<policy>(frame.branchLevel);
+    frame.component++;
+    
+    if (branchAndBound && probComponent <= frame.childLower && frame.component < frame.numComponents) {
+        ++numComponentPrunes;
+        frame.product = min(frame.product, frame.lower);
+    }
+    else if (frame.component < frame.numComponents && frame.product > FAILURE) {
+        openComponent<policy>(frame);
+        return false;
+    }
+    
+    if (policy::words) {
+        bitScratch.resize(frame.scratch);
+    }
+    else {
+        componentScratch.resize(frame.scratch);
+    }
+    undoTo<policy>(frame.level);
+    
+    if (branchAndBound && frame.product <= frame.lower) {
+        *probability = min(frame.product * frame.unitProbability, frame.low);
+    }
+    else {
+        *probability = frame.product * frame.unitProbability;
+    }
+    return true;
     
-    //going through every entry in clauseSet to udpate based on the variable's assignment
-    for (map<int, int>::iterator it = (*clauseSet).begin(); it != (*clauseSet).end(); it++) {
+    //END COMPONENT DECOMPOSITION
+}
+
+/***************************************************************************
+ Function:  window
+ Inputs:    bound of a window
+ Returns:   the bound clipped to [FAILURE, SUCCESS]
+ Description:   a probability cannot be outside [0, 1], so a bound at 0 or 1
+                is as good as any bound further out. A result at the clipped
+                bound is then exact, never a bound outside [0, 1]
+ ***************************************************************************/
+double window(double bound) {
+
+    return min(max(bound, (double)FAILURE), (double)SUCCESS);
+}
+
+/***************************************************************************
+ Function:  numPrunes
+ Inputs:    none
+ Returns:   number of subformulas skipped by branch and bound so far
+ Description:   sum of the counts of all pruning rules
+ ***************************************************************************/
+int searchCounters::numPrunes() {
+
+    return numChoicePrunes + numChanceLowerPrunes + numChanceUpperPrunes + numComponentPrunes;
+}
+
+/***************************************************************************
+ Function:  numInexact
+ Inputs:    none
+ Returns:   number of times a bound was used in place of an exact value
+ Description:   if this does not change while a formula is solved, its
+                result is exact, whatever its window was
+ ***************************************************************************/
+int searchCounters::numInexact() {
+
+    return numPrunes() + numCacheBoundHits + numBoundJoins;
+}
+
+/***************************************************************************
+ Function:  updateClausesAndVariables
+ Inputs:    variable and the value assigned to it
+ Returns:   none
+ Description:   deactivate all satisfied clauses after a given assignment,
+                shrink the clauses where the assigned literal is false and
+                update the member counts of affected variables; every change
+                is pushed on the trail for undoChanges
+ ***************************************************************************/
+void formulaState::updateClausesAndVariables(int variable, int value) {
+
+    STATS_PHASE(PHASE_UPDATE);
+    trailEntry entry;
+
+    //variable becomes inactive
+    assignment[variable] = value;
+    deactivateVariable(variable);
+    entry.kind = TRAIL_ASSIGNED;
+    entry.index = variable;
+    trail.push_back(entry);
+
+    //going through every clause the variable appears in to update based on the variable's assignment
+    for (int o = db.occurrenceStart[variable]; o < db.occurrenceStart[variable + 1]; o++) {
 
         //storing intermediate value to variables
-        int clauseEntry = it->first;
-        int clauseEntryValue = it->second;
+        int clauseEntry = db.occurrences[o];
+        int clauseEntryValue = db.occurrenceSign[o];
+        
+        //satisfied clauses are not part of the formula anymore
+        if (!clauseActive[clauseEntry]) {
+            continue;
+        }
         
         //remove clauses that have the true-value variables
         if (clauseEntryValue == value) {
             
-            //save clauses that have been satisfied for undoChanges
-            (*savedSATClausesPtr).insert(pair<int, set<int> >(clauseEntry, clauses[clauseEntry]));
-            
-            //going through every literal in the satisfied clause to update its variables' clauseMembers
-            for (set<int>::iterator iter = clauses[clauseEntry].begin(); iter != clauses[clauseEntry].end(); iter++) {
+            //going through every literal in the satisfied clause to update its variables' member counts
+            for (int l = db.clauseStart[clauseEntry]; l < db.clauseStart[clauseEntry + 1]; l++) {
                 
-                //keys in variables map are always positive
-                int removedVar = abs(*iter);
+                int removedVar = abs(db.literals[l]);
                 
-                //skip the being examined variable because we will delete them from
-                //variables map later
-                if (removedVar == variable) {
+                //skip assigned variables (including the one being examined) because they are
+                //not part of the formula anymore
+                if (assignment[removedVar] != INVALID) {
                     continue;
                 }
                 
-                //if removedVar is active (i.e in the variables map) then remove the
-                //clauseEntry from removedVar's clauseMember map. If removedVar is not active then continue.
-                if (variables.find(removedVar) != variables.end()) {
-                    variables[removedVar].clauseMembers.erase(clauseEntry);
-                    
-                    //if removedVar's clauseMember map has no keys then erase removedVar from variables map 
-                    if (variables[removedVar].clauseMembers.empty() == true) {
-
-                        //save before erasing for undoChanges
-                        (*savedInactiveVariables).insert(pair<int, double>(removedVar, variables[removedVar].quantifier));
-
-                        variables.erase(removedVar);
+                int remaining = (db.literals[l] > 0) ? --positiveMembers[removedVar]
+                                                     : --negativeMembers[removedVar];
+                if (scoreKind != SCORE_NONE) {
+                    if (trackSizes) {
+                        removeClauseSize(removedVar, clauseSize[clauseEntry]);
                     }
+                    markScore(removedVar);
+                }
+                if (remaining > 0) {
+                    continue;
+                }
+                
+                //if removedVar is in no other active clause then it becomes inactive
+                if (positiveMembers[removedVar] + negativeMembers[removedVar] == 0) {
+                    deactivateVariable(removedVar);
+                    entry.kind = TRAIL_INACTIVE;
+                    entry.index = removedVar;
+                    trail.push_back(entry);
+                }
+                
+                //otherwise it is now pure in the remaining clauses
+                else if (quantifier[removedVar] == CHOICE_VALUE) {
+                    pureQueue.push_back(removedVar);
+                    push_heap(pureQueue.begin(), pureQueue.end(), greater<int>());
                 }
             }
             
-            //clauseEntry becomes inactive, removed from clauses
-            clauses.erase(clauseEntry);
+            //clauseEntry becomes inactive
+            clauseActive[clauseEntry] = false;
+            toggleClause(clauseEntry);
+            numActiveClauses--;
+            entry.kind = TRAIL_SATISFIED;
+            entry.index = clauseEntry;
+            trail.push_back(entry);
         }
         
-        //remove the falsely assigned variable in the clauses
+        //the falsely assigned literal no longer counts in the clause
         else {
 
-            //save before erasing for undoChanges
-            (*savedFalseLiteralClausePtr).push_back(clauseEntry);
-
-            //making sure the removed value match the key's set's entry
-            clauses[clauseEntry].erase(NEGATIVE * value * variable);
-            
             //problem unsolvable if there is at least one unsatisfiable clause
-            if (clauses[clauseEntry].empty() == true) {
+            if (--clauseSize[clauseEntry] == 0) {
                 UNSATclauseExists = true;
             }
+            
+            //the clause just became a unit clause
+            else if (clauseSize[clauseEntry] == UNIT_SIZE) {
+                unitQueue.push_back(clauseEntry);
+                push_heap(unitQueue.begin(), unitQueue.end(), greater<int>());
+            }
+            if (trackSizes) {
+                resizeClause(clauseEntry, clauseSize[clauseEntry] + 1, clauseSize[clauseEntry]);
+            }
+            entry.kind = TRAIL_HIDDEN;
+            entry.index = clauseEntry;
+            trail.push_back(entry);
+        }
+    }
+}
+
+
+/***************************************************************************
+ Function:  undoChanges
+ Inputs:    trail size to go back to
+ Returns:   none
+ Description:   undo changes made before call to SOLVESSAT by popping the
+                trail, most recent change first
+ ***************************************************************************/
+void formulaState::undoChanges(unsigned int level){
+    
+    STATS_PHASE(PHASE_UNDO);
+    while (trail.size() > level) {
+        
+        trailEntry entry = trail.back();
+        trail.pop_back();
+        
+        switch (entry.kind) {
+                
+            //put back the falsely assigned literal
+            case TRAIL_HIDDEN:
+                if (clauseSize[entry.index]++ == 0) {
+                    UNSATclauseExists = false;
+                }
+                if (trackSizes) {
+                    resizeClause(entry.index, clauseSize[entry.index] - 1, clauseSize[entry.index]);
+                }
+                break;
+                
+            //put back the satisfied clause and the member counts of its unassigned variables
+            case TRAIL_SATISFIED:
+                clauseActive[entry.index] = true;
+                toggleClause(entry.index);
+                numActiveClauses++;
+                for (int l = db.clauseStart[entry.index]; l < db.clauseStart[entry.index + 1]; l++) {
+                    int savedVariable = abs(db.literals[l]);
+                    if (assignment[savedVariable] == INVALID) {
+                        if (db.literals[l] > 0) {
+                            positiveMembers[savedVariable]++;
+                        }
+                        else {
+                            negativeMembers[savedVariable]++;
+                        }
+                        if (scoreKind != SCORE_NONE) {
+                            if (trackSizes) {
+                                addClauseSize(savedVariable, clauseSize[entry.index]);
+                            }
+                            markScore(savedVariable);
+                        }
+                    }
+                }
+                break;
+                
+            //put back a clause of another component
+            case TRAIL_SET_ASIDE:
+                clauseActive[entry.index] = true;
+                toggleClause(entry.index);
+                numActiveClauses++;
+                break;
+                
+            //put back a variable that became inactive or belongs to another component
+            case TRAIL_INACTIVE:
+            case TRAIL_VAR_SET_ASIDE:
+                reactivateVariable(entry.index);
+                break;
+                
+            //restore the assigned variable
+            default:
+                assignment[entry.index] = INVALID;
+                reactivateVariable(entry.index);
+                break;
+        }
+    }
+}
+
+/***************************************************************************
+ Function:  propagateUnits
+ Inputs:    none
+ Returns:   product of the probabilities of the chance variables it assigned
+ Description:   assigns the literal of every unit clause, lowest clause index
+                first, including the units that the assignments create, until
+                no unit is left, the formula is satisfied or a clause is empty.
+                The unit queue holds exactly the clauses whose size dropped to
+                one, so this costs time in the number of implied units rather
+                than in the size of the formula. Changes go on the trail and are
+                undone by the caller.
+ ***************************************************************************/
+double formulaState::propagateUnits() {
+
+    STATS_PHASE(PHASE_UCP);
+    double probability = SUCCESS;
+    
+    while (!unitQueue.empty()) {
+        
+        pop_heap(unitQueue.begin(), unitQueue.end(), greater<int>());
+        int c = unitQueue.back();
+        unitQueue.pop_back();
+        
+        //the clause may have been satisfied since it was queued
+        if (!clauseActive[c] || clauseSize[c] != UNIT_SIZE) {
+            continue;
+        }
+        
+        //updating total number of UCP
+        ++numUCP;
+        
+        //the only literal of the clause whose variable is not assigned yet
+        int literal = 0;
+        for (int l = db.clauseStart[c]; l < db.clauseStart[c + 1]; l++) {
+            if (assignment[abs(db.literals[l])] == INVALID) {
+                literal = db.literals[l];
+                break;
+            }
+        }
+        
+        int v = abs(literal);
+        int value = (literal > 0) ? POSITIVE : NEGATIVE;
+        
+        //the below part resemebles the algorithm distributed by professor Majercik
+        updateClausesAndVariables(v, value);
+        
+        if (quantifier[v] != CHOICE_VALUE) {
+            probability *= (value == NEGATIVE) ? (1 - quantifier[v]) : quantifier[v];
+        }
+        
+        //stop as soon as the node would be decided anyway
+        if (numActiveClauses == 0 || UNSATclauseExists || numActiveVars == 0) {
+            break;
+        }
+    }
+    
+    return probability;
+}
+
+/***************************************************************************
+ Function:  eliminatePureChoices
+ Inputs:    none
+ Returns:   none
+ Description:   assigns every pure choice variable its pure value, lowest
+                variable first, including the ones made pure by earlier
+                eliminations, until none is left or the formula is decided.
+                Variables enter the pure queue when one of their occurrence
+                counters drops to zero, so no variable has to be scanned.
+                Changes go on the trail and are undone by the caller.
+ ***************************************************************************/
+void formulaState::eliminatePureChoices() {
+
+    STATS_PHASE(PHASE_PVE);
+    while (!pureQueue.empty()) {
+        
+        pop_heap(pureQueue.begin(), pureQueue.end(), greater<int>());
+        int v = pureQueue.back();
+        pureQueue.pop_back();
+        
+        //the variable may have been assigned or deactivated since it was queued
+        if (!varActive[v]) {
+            continue;
+        }
+        
+        pair<bool, int> result = isPureChoice(v);
+        if (result.first == false) {
+            continue;
+        }
+        
+        //updating total number of PVE
+        ++numPVE;
+        
+        //the below part resemebles the algorithm distributed by professor Majercik
+        updateClausesAndVariables(v, result.second);
+        
+        //stop as soon as the node would be decided anyway
+        if (numActiveClauses == 0 || numActiveVars == 0) {
+            break;
+        }
+    }
+}
+
+/***************************************************************************
+ Function:  initQueues
+ Inputs:    none
+ Returns:   none
+ Description:   fills the unit queue with the unit clauses and the pure queue
+                with the pure choice variables of the formula before a new
+                search starts from the root
+ ***************************************************************************/
+void formulaState::initQueues() {
+
+    unitQueue.clear();
+    unitQueue.reserve(numClauses);
+    for (int c = 0; c < numClauses; c++) {
+        if (clauseActive[c] && clauseSize[c] == UNIT_SIZE) {
+            unitQueue.push_back(c);
+        }
+    }
+    make_heap(unitQueue.begin(), unitQueue.end(), greater<int>());
+    
+    pureQueue.clear();
+    pureQueue.reserve(numVars);
+    for (int v = 1; v <= numVars; v++) {
+        if (varActive[v] && isPureChoice(v).first) {
+            pureQueue.push_back(v);
+        }
+    }
+    make_heap(pureQueue.begin(), pureQueue.end(), greater<int>());
+    
+    //the same for the bitset engine, whose last run may have left its last key behind
+    if (bitWords > 0) {
+        fill(bitUnits.begin(), bitUnits.end(), 0ULL);
+        fill(bitPures.begin(), bitPures.end(), 0ULL);
+        for (unsigned int i = 0; i < unitQueue.size(); i++) {
+            bitUnits[unitQueue[i] / WORD_BITS] |= 1ULL << (unitQueue[i] % WORD_BITS);
+        }
+        for (unsigned int i = 0; i < pureQueue.size(); i++) {
+            bitPures[(pureQueue[i] - 1) / WORD_BITS] |= 1ULL << ((pureQueue[i] - 1) % WORD_BITS);
+        }
+        initFormulaKey();
+    }
+}
+
+/***************************************************************************/
+/* FORMULA CACHE */
+
+/***************************************************************************
+ Function:  toggleClause
+ Inputs:    clause
+ Returns:   none
+ Description:   flips the clause in the formula key and its hash; called
+                whenever the clause is deactivated or put back
+ ***************************************************************************/
+void formulaState::toggleClause(int clause) {
+
+    formulaKey[clause / WORD_BITS] ^= 1ULL << (clause % WORD_BITS);
+    formulaHash ^= zobrist[clause];
+}
+
+/***************************************************************************
+ Function:  toggleVariable
+ Inputs:    variable
+ Returns:   none
+ Description:   flips the variable in the formula key and its hash; called
+                whenever the variable is deactivated or put back
+ ***************************************************************************/
+void formulaState::toggleVariable(int variable) {
+
+    int bit = numClauses + variable;
+    formulaKey[bit / WORD_BITS] ^= 1ULL << (bit % WORD_BITS);
+    formulaHash ^= zobrist[bit];
+}
+
+/***************************************************************************
+ Function:  deactivateVariable
+ Inputs:    variable
+ Returns:   none
+ Description:   takes the variable out of the formula: out of the key and to
+                the inactive end of its block
+ ***************************************************************************/
+void formulaState::deactivateVariable(int variable) {
+
+    varActive[variable] = false;
+    toggleVariable(variable);
+    numActiveVars--;
+    if (!trackBlocks) {
+        return;
+    }
+    
+    //swap it with the last active variable of the block
+    int block = varBlock[variable];
+    int last = blockStart[block] + --blockActive[block];
+    int other = blockVars[last];
+    blockVars[blockPosition[variable]] = other;
+    blockPosition[other] = blockPosition[variable];
+    blockVars[last] = variable;
+    blockPosition[variable] = last;
+}
+
+/***************************************************************************
+ Function:  reactivateVariable
+ Inputs:    variable
+ Returns:   none
+ Description:   puts the variable back into the formula and among the
+                active variables of its block
+ ***************************************************************************/
+void formulaState::reactivateVariable(int variable) {
+
+    varActive[variable] = true;
+    toggleVariable(variable);
+    numActiveVars++;
+    if (!trackBlocks) {
+        return;
+    }
+    
+    //swap it with the first inactive variable of the block, which it already
+    //is when changes are undone in order
+    int block = varBlock[variable];
+    int first = blockStart[block] + blockActive[block]++;
+    int other = blockVars[first];
+    blockVars[blockPosition[variable]] = other;
+    blockPosition[other] = blockPosition[variable];
+    blockVars[first] = variable;
+    blockPosition[variable] = first;
+    
+    //back into the heap if the split heuristic has taken it out
+    if (scoreKind != SCORE_NONE && heapPosition[variable] < 0 && varHeaped[variable]) {
+        pushHeap(variable);
+    }
+}
+
+/***************************************************************************
+ Function:  initFormulaKey
+ Inputs:    none
+ Returns:   none
+ Description:   builds the key of the full formula
+ ***************************************************************************/
+void formulaState::initFormulaKey() {
+
+    int bits = numClauses + numVars + 1;
+    formulaKey.assign((bits + WORD_BITS - 1) / WORD_BITS, 0);
+    formulaHash = 0;
+    
+    for (int c = 0; c < numClauses; c++) {
+        if (clauseActive[c]) {
+            toggleClause(c);
+        }
+    }
+    for (int v = 1; v <= numVars; v++) {
+        if (varActive[v]) {
+            toggleVariable(v);
+        }
+    }
+}
+
+/***************************************************************************
+ Function:  initCache
+ Inputs:    cache, words of a formula key, memory cap in megabytes (0 turns
+            the cache off)
+ Returns:   none
+ Description:   empties the cache before a run
+ ***************************************************************************/
+void initCache(formulaCache &cache, unsigned int keyWords, double megabytes) {
+
+    cache.keyWords = keyWords;
+    cache.used = 0;
+    cache.maxSlots = 0;
+    
+    //largest power of two number of slots that fits in the cap
+    size_t slotBytes = sizeof(cacheSlot) + cache.keyWords * sizeof(unsigned long long);
+    size_t capSlots = (size_t)(megabytes * 1024 * 1024) / slotBytes;
+    if (capSlots >= MIN_CACHE_SLOTS) {
+        cache.maxSlots = MIN_CACHE_SLOTS;
+        while (cache.maxSlots * 2 <= capSlots) {
+            cache.maxSlots *= 2;
+        }
+    }
+    
+    size_t initialSlots = min(cache.maxSlots, (size_t)MIN_CACHE_SLOTS);
+    cacheSlot empty = {0, 0.0, 0, CACHE_EXACT};
+    cache.slots.assign(initialSlots, empty);
+    cache.keys.assign(initialSlots * cache.keyWords, 0);
+}
+
+/***************************************************************************
+ Function:  lookupCache
+ Inputs:    window of interesting values, where to write the probability
+ Returns:   true if the current formula is in the cache and its entry
+            answers the window
+ Description:   probes the slots of the current formula's hash and compares
+                full keys, so hash collisions never give a wrong answer. A
+                bound only answers a window it is outside of
+ ***************************************************************************/
+bool formulaState::lookupCache(double low, double high, double* probability) {
+
+    unsigned long long hash = formulaHash ? formulaHash : 1;
+    size_t mask = cache->slots.size() - 1;
+    
+    for (unsigned int p = 0; p < CACHE_PROBES; p++) {
+        size_t i = (hash + p) & mask;
+        if (cache->slots[i].hash == 0) {
+            return false;
+        }
+        if (cache->slots[i].hash == hash &&
+            equal(formulaKey.begin(), formulaKey.end(), cache->keys.begin() + i * cache->keyWords)) {
+            *probability = cache->slots[i].probability;
+            if (cache->slots[i].bound == CACHE_EXACT) {
+                return true;
+            }
+            if ((cache->slots[i].bound == CACHE_UPPER && *probability <= low) ||
+                (cache->slots[i].bound == CACHE_LOWER && *probability >= high)) {
+                ++numCacheBoundHits;
+                return true;
+            }
+            return false;
+        }
+    }
+    return false;
+}
+
+/***************************************************************************
+ Function:  storeCache
+ Inputs:    probability of the current formula, what kind of value it is
+            and the work it took
+ Returns:   none
+ Description:   stores the current formula, growing the table while it is
+                under the memory cap; when it is full, the entry that took
+                the fewest splits among the probed slots is evicted. A bound
+                that did not answer a later window is replaced in place
+ ***************************************************************************/
+void formulaState::storeCache(double probability, int bound, unsigned int work) {
+
+    if (4 * (cache->used + 1) > 3 * cache->slots.size() && cache->slots.size() < cache->maxSlots) {
+        growCache(*cache);
+    }
+    
+    unsigned long long hash = formulaHash ? formulaHash : 1;
+    size_t mask = cache->slots.size() - 1;
+    size_t victim = hash & mask;
+    
+    for (unsigned int p = 0; p < CACHE_PROBES; p++) {
+        size_t i = (hash + p) & mask;
+        if (cache->slots[i].hash == 0) {
+            victim = i;
+            cache->used++;
+            break;
+        }
+        if (cache->slots[i].hash == hash &&
+            equal(formulaKey.begin(), formulaKey.end(), cache->keys.begin() + i * cache->keyWords)) {
+            victim = i;
+            break;
+        }
+        if (cache->slots[i].work < cache->slots[victim].work) {
+            victim = i;
+        }
+    }
+    
+    cache->slots[victim].hash = hash;
+    cache->slots[victim].probability = probability;
+    cache->slots[victim].work = work;
+    cache->slots[victim].bound = bound;
+    copy(formulaKey.begin(), formulaKey.end(), cache->keys.begin() + victim * cache->keyWords);
+}
+
+/***************************************************************************
+ Function:  growCache
+ Inputs:    cache
+ Returns:   none
+ Description:   doubles the number of slots and reinserts every entry
+ ***************************************************************************/
+void growCache(formulaCache &cache) {
+
+    vector<cacheSlot> oldSlots;
+    vector<unsigned long long> oldKeys;
+    oldSlots.swap(cache.slots);
+    oldKeys.swap(cache.keys);
+    
+    cacheSlot empty = {0, 0.0, 0, CACHE_EXACT};
+    cache.slots.assign(oldSlots.size() * 2, empty);
+    cache.keys.assign(cache.slots.size() * cache.keyWords, 0);
+    cache.used = 0;
+    size_t mask = cache.slots.size() - 1;
+    
+    for (size_t o = 0; o < oldSlots.size(); o++) {
+        if (oldSlots[o].hash == 0) {
+            continue;
+        }
+        
+        //a slot that cannot be placed within the probe window is dropped
+        for (unsigned int p = 0; p < CACHE_PROBES; p++) {
+            size_t i = (oldSlots[o].hash + p) & mask;
+            if (cache.slots[i].hash == 0) {
+                cache.slots[i] = oldSlots[o];
+                copy(oldKeys.begin() + o * cache.keyWords, oldKeys.begin() + (o + 1) * cache.keyWords,
+                     cache.keys.begin() + i * cache.keyWords);
+                cache.used++;
+                break;
+            }
+        }
+    }
+}
+
+/***************************************************************************/
+/* COMPONENT DECOMPOSITION */
+
+/***************************************************************************
+ Function:  findComponents
+ Inputs:    frame of the current formula
+ Returns:   true if the formula falls apart into independent components
+ Description:   groups the active clauses into components that share no
+                variable. If there is more than one, each is solved on its own
+                by setting the other clauses and variables aside on the trail,
+                and the probability is the product of theirs. This holds for
+                any quantifier prefix: a variable of one component never
+                changes the value of another, so at every choice or chance
+                node of either the other factor is a constant. Every component
+                gets its own cache entry. The components are noted on the
+                scratch stack for enterComponent
+ ***************************************************************************/
+bool formulaState::findComponents(searchFrame &frame) {
+
+    //start from any variable that is still in a clause
+    int start = INVALID;
+    for (int v = 1; v <= numVars && start == INVALID; v++) {
+        if (varActive[v] && positiveMembers[v] + negativeMembers[v] > 0) {
+            start = v;
+        }
+    }
+    if (start == INVALID) {
+        return false;
+    }
+    
+    //labels only grow; start over long before they would wrap around
+    if (componentLabel > UINT_MAX - 2 * (unsigned int)numVars) {
+        varComponent.assign(numVars + 1, 0);
+        clauseComponent.assign(numClauses, 0);
+        componentLabel = 0;
+    }
+    
+    //the usual case: everything is reachable from the first variable
+    unsigned int firstLabel = ++componentLabel;
+    if (labelComponent(start, firstLabel) == numActiveClauses) {
+        return false;
+    }
+    
+    ++numComponentSplits;
+    
+    //label the other components, which get the labels after the first one
+    for (int v = start + 1; v <= numVars; v++) {
+        if (varActive[v] && positiveMembers[v] + negativeMembers[v] > 0 && varComponent[v] < firstLabel) {
+            labelComponent(v, ++componentLabel);
+        }
+    }
+    frame.firstLabel = firstLabel;
+    frame.numComponents = componentLabel - firstLabel + 1;
+    
+    //the nested searches label again, so note the component of every active clause
+    //and variable on the scratch stack; nested splits push above this part
+    frame.scratch = componentScratch.size();
+    for (int c = 0; c < numClauses; c++) {
+        if (clauseActive[c]) {
+            componentScratch.push_back(c);
+            componentScratch.push_back(clauseComponent[c]);
+        }
+    }
+    for (int v = 1; v <= numVars; v++) {
+        if (varActive[v]) {
+            
+            //variables in no clause are in no component and are set aside for all of them
+            componentScratch.push_back(v);
+            componentScratch.push_back(varComponent[v] >= firstLabel ? varComponent[v] : 0);
+        }
+    }
+    
+    return true;
+}
+
+/***************************************************************************
+ Function:  enterComponent
+ Inputs:    frame whose components were found
+ Returns:   none
+ Description:   sets aside every clause and variable that is not in the
+                frame's current component. The formula is the same as when
+                the components were noted, so the counts give where the
+                variables start on the scratch stack
+ ***************************************************************************/
+void formulaState::enterComponent(searchFrame &frame) {
+
+    unsigned int label = frame.firstLabel + frame.component;
+    unsigned int varBase = frame.scratch + 2 * numActiveClauses;
+    unsigned int end = varBase + 2 * numActiveVars;
+    
+    for (unsigned int i = frame.scratch; i < varBase; i += 2) {
+        if ((unsigned int)componentScratch[i + 1] != label) {
+            setAsideClause(componentScratch[i]);
+        }
+    }
+    for (unsigned int i = varBase; i < end; i += 2) {
+        if ((unsigned int)componentScratch[i + 1] != label) {
+            setAsideVariable(componentScratch[i]);
+        }
+    }
+}
+
+/***************************************************************************
+ Function:  setAsideClause
+ Inputs:    clause
+ Returns:   none
+ Description:   takes an active clause out of the formula while another
+                component is solved; undoChanges puts it back
+ ***************************************************************************/
+void formulaState::setAsideClause(int clause) {
+
+    trailEntry entry;
+    clauseActive[clause] = false;
+    toggleClause(clause);
+    numActiveClauses--;
+    entry.kind = TRAIL_SET_ASIDE;
+    entry.index = clause;
+    trail.push_back(entry);
+}
+
+/***************************************************************************
+ Function:  setAsideVariable
+ Inputs:    variable
+ Returns:   none
+ Description:   takes an active variable out of the formula while another
+                component is solved; undoChanges puts it back
+ ***************************************************************************/
+void formulaState::setAsideVariable(int variable) {
+
+    trailEntry entry;
+    deactivateVariable(variable);
+    entry.kind = TRAIL_VAR_SET_ASIDE;
+    entry.index = variable;
+    trail.push_back(entry);
+}
+
+/***************************************************************************
+ Function:  labelComponent
+ Inputs:    a variable that is in an active clause and a fresh label
+ Returns:   number of active clauses in the variable's component
+ Description:   gives the label to every active clause and unassigned
+                variable reachable from the variable through active clauses
+ ***************************************************************************/
+int formulaState::labelComponent(int start, unsigned int label) {
+
+    int reached = 0;
+    int queued = 0;
+    
+    varComponent[start] = label;
+    componentQueue[queued++] = start;
+    
+    while (queued > 0) {
+        int v = componentQueue[--queued];
+        
+        for (int o = db.occurrenceStart[v]; o < db.occurrenceStart[v + 1]; o++) {
+            int c = db.occurrences[o];
+            if (!clauseActive[c] || clauseComponent[c] == label) {
+                continue;
+            }
+            clauseComponent[c] = label;
+            reached++;
+            
+            for (int l = db.clauseStart[c]; l < db.clauseStart[c + 1]; l++) {
+                int u = abs(db.literals[l]);
+                if (assignment[u] == INVALID && varComponent[u] != label) {
+                    varComponent[u] = label;
+                    componentQueue[queued++] = u;
+                }
+            }
+        }
+    }
+    
+    return reached;
+}
+
+/***************************************************************************/
+/* LEAF SOLVER */
+
+//bit a of these is set if bit j of a is, for j < 6: the assignments of a
+//64-bit word of a truth table that set its variable j to TRUE
+static const unsigned long long LEAF_TRUE_BITS[] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+};
+
+/***************************************************************************
+ Function:  solveLeaf
+ Inputs:    none
+ Returns:   probability of the current formula, exact
+ Description:   solves a formula of at most leafMaxVars variables without
+                splits. Its k variables (in prefix order) number its 2^k
+                assignments, and every active clause becomes the truth table
+                of the assignments that satisfy it, built a word at a time
+                from the table of each of its literals. The formula is the
+                AND of those, and foldLeaf takes its value. Nothing in the
+                state changes, so there is nothing to undo
+ ***************************************************************************/
+double formulaState::solveLeaf() {
+
+    ++numLeafSolves;
+    
+    //the variables still in a clause; the others cannot change the value
+    leafVars.clear();
+    leafBit.resize(numVars + 1);
+    for (int v = 1; v <= numVars; v++) {
+        if (varActive[v] && positiveMembers[v] + negativeMembers[v] > 0) {
+            leafBit[v] = leafVars.size();
+            leafVars.push_back(v);
+        }
+    }
+    int words = (leafVars.size() > 6) ? 1 << (leafVars.size() - 6) : 1;
+    
+    //AND of the tables of the active clauses
+    leafTable.assign(words, ~0ULL);
+    leafClause.resize(words);
+    for (int c = 0; c < numClauses; c++) {
+        if (!clauseActive[c]) {
+            continue;
+        }
+        fill(leafClause.begin(), leafClause.begin() + words, 0ULL);
+        for (int l = db.clauseStart[c]; l < db.clauseStart[c + 1]; l++) {
+            int v = abs(db.literals[l]);
+            if (assignment[v] != INVALID || !varActive[v]) {
+                continue;
+            }
+            addLeafLiteral(leafBit[v], db.literals[l] > 0, words);
+        }
+        if (!andLeafClause(words)) {
+            return FAILURE;
+        }
+    }
+    
+    return foldLeaf();
+}
+
+/***************************************************************************
+ Function:  addLeafLiteral
+ Inputs:    bit of the literal's variable, its sign, words of the table
+ Returns:   none
+ Description:   adds the assignments that make the literal true to the
+                table of the clause being built
+ ***************************************************************************/
+void formulaState::addLeafLiteral(int bit, bool positive, int words) {
+
+    if (bit < 6) {
+        unsigned long long bits = positive ? LEAF_TRUE_BITS[bit] : ~LEAF_TRUE_BITS[bit];
+        for (int w = 0; w < words; w++) {
+            leafClause[w] |= bits;
+        }
+    }
+    else {
+        for (int w = 0; w < words; w++) {
+            if ((((w >> (bit - 6)) & 1) != 0) == positive) {
+                leafClause[w] = ~0ULL;
+            }
+        }
+    }
+}
+
+/***************************************************************************
+ Function:  andLeafClause
+ Inputs:    words of the table
+ Returns:   false if no assignment satisfies the clauses so far
+ Description:   ANDs the table of the clause just built into the formula's
+ ***************************************************************************/
+bool formulaState::andLeafClause(int words) {
+
+    bool satisfiable = false;
+    for (int w = 0; w < words; w++) {
+        leafTable[w] &= leafClause[w];
+        satisfiable |= (leafTable[w] != 0);
+    }
+    return satisfiable;
+}
+
+/***************************************************************************
+ Function:  foldLeaf
+ Inputs:    none
+ Returns:   probability of the formula whose table is in leafTable
+ Description:   the innermost choice variables are taken out of the table
+                by OR-ing its halves; the rest is expanded to probabilities
+                and folded from the innermost variable out, max for choice
+                and the weighted sum for chance, over contiguous halves the
+                compiler can vectorize
+ ***************************************************************************/
+double formulaState::foldLeaf() {
+
+    //innermost choice variables: an assignment of the others is satisfied if
+    //either value of the variable satisfies it
+    int j = leafVars.size() - 1;
+    while (j >= 0 && quantifier[leafVars[j]] == CHOICE_VALUE) {
+        int half = 1 << j;
+        if (half >= WORD_BITS) {
+            for (int w = 0; w < half / WORD_BITS; w++) {
+                leafTable[w] |= leafTable[w + half / WORD_BITS];
+            }
+        }
+        else {
+            leafTable[0] |= leafTable[0] >> half;
+        }
+        j--;
+    }
+    if (j < 0) {
+        return (leafTable[0] & 1) ? SUCCESS : FAILURE;
+    }
+    
+    //the variables left, as probabilities; FALSE is the lower half of every split
+    int size = 1 << (j + 1);
+    if ((int)leafValues.size() < size) {
+        leafValues.resize(size);
+    }
+    double* values = &leafValues[0];
+    for (int a = 0; a < size; a++) {
+        values[a] = (double)((leafTable[a / WORD_BITS] >> (a % WORD_BITS)) & 1);
+    }
+    for (; j >= 0; j--) {
+        int half = 1 << j;
+        double probTrue = quantifier[leafVars[j]];
+        if (probTrue == CHOICE_VALUE) {
+            for (int a = 0; a < half; a++) {
+                values[a] = max(values[a], values[a + half]);
+            }
+        }
+        else {
+            double probFalse = 1 - probTrue;
+            for (int a = 0; a < half; a++) {
+                values[a] = values[a] * probFalse + values[a + half] * probTrue;
+            }
+        }
+    }
+    
+    return values[0];
+}
+
+/***************************************************************************/
+/* BITSET ENGINE */
+
+/***************************************************************************
+ Function:  initBitset
+ Inputs:    none
+ Returns:   none
+ Description:   builds the masks of the bitset engine and its root state if
+                the instance is small enough for it, and leaves bitWords at
+                0 otherwise. A variable twice in a clause would count once
+                in a mask, so such instances keep to the clause arena
+ ***************************************************************************/
+void formulaState::initBitset() {
+
+    bitWords = 0;
+    clauseWords = (numClauses + WORD_BITS - 1) / WORD_BITS;
+    
+    //the smallest of 1, 2, 4 words that holds every variable
+    int words = 1;
+    while (words * WORD_BITS < numVars) {
+        words *= 2;
+    }
+    if (numVars == 0 || words > BITSET_MAX_WORDS) {
+        return;
+    }
+    vector<int> seen(numVars + 1, -1);
+    for (int c = 0; c < numClauses; c++) {
+        for (int l = db.clauseStart[c]; l < db.clauseStart[c + 1]; l++) {
+            int v = abs(db.literals[l]);
+            if (seen[v] == c) {
+                return;
+            }
+            seen[v] = c;
+        }
+    }
+    bitWords = words;
+    
+    bitPositive.assign(numClauses * bitWords, 0);
+    bitNegative.assign(numClauses * bitWords, 0);
+    bitPositiveIn.assign((numVars + 1) * clauseWords, 0);
+    bitNegativeIn.assign((numVars + 1) * clauseWords, 0);
+    for (int c = 0; c < numClauses; c++) {
+        for (int l = db.clauseStart[c]; l < db.clauseStart[c + 1]; l++) {
+            int v = abs(db.literals[l]);
+            unsigned long long varBit = 1ULL << ((v - 1) % WORD_BITS);
+            unsigned long long clauseBit = 1ULL << (c % WORD_BITS);
+            if (db.literals[l] > 0) {
+                bitPositive[c * bitWords + (v - 1) / WORD_BITS] |= varBit;
+                bitPositiveIn[v * clauseWords + c / WORD_BITS] |= clauseBit;
+            }
+            else {
+                bitNegative[c * bitWords + (v - 1) / WORD_BITS] |= varBit;
+                bitNegativeIn[v * clauseWords + c / WORD_BITS] |= clauseBit;
+            }
+        }
+    }
+    
+    bitChoice.assign(bitWords, 0);
+    bitBlock.assign(numBlocks * bitWords, 0);
+    for (int v = 1; v <= numVars; v++) {
+        unsigned long long varBit = 1ULL << ((v - 1) % WORD_BITS);
+        if (quantifier[v] == CHOICE_VALUE) {
+            bitChoice[(v - 1) / WORD_BITS] |= varBit;
+        }
+        bitBlock[varBlock[v] * bitWords + (v - 1) / WORD_BITS] |= varBit;
+    }
+    
+    //the root: nothing assigned, every variable and clause active
+    bitState.assign(4 * bitWords + clauseWords, 0);
+    unsigned long long* active = &bitState[bitWords];
+    unsigned long long* positive = &bitState[2 * bitWords];
+    unsigned long long* negative = &bitState[3 * bitWords];
+    unsigned long long* clauses = &bitState[4 * bitWords];
+    for (int v = 1; v <= numVars; v++) {
+        active[(v - 1) / WORD_BITS] |= 1ULL << ((v - 1) % WORD_BITS);
+    }
+    for (int c = 0; c < numClauses; c++) {
+        clauses[c / WORD_BITS] |= 1ULL << (c % WORD_BITS);
+        for (int i = 0; i < bitWords; i++) {
+            positive[i] |= bitPositive[c * bitWords + i];
+            negative[i] |= bitNegative[c * bitWords + i];
+        }
+    }
+    
+    //a frame for every entry the trail can hold along one branch
+    bitFrames.clear();
+    bitFrames.reserve((2 * numVars + 1) * (bitState.size() + BITSET_FRAME_COUNTS));
+    bitUnits.assign(clauseWords, 0);
+    bitPures.assign(bitWords, 0);
+    bitScratch.clear();
+    bitSizes.assign(numClauses, 0);
+}
+
+/***************************************************************************
+ Function:  bitSave
+ Inputs:    kind and index of the change about to be made
+ Returns:   none
+ Description:   saves bitState and its counts as the frame of a new trail
+                entry, which bitUndo copies back
+ ***************************************************************************/
+void formulaState::bitSave(int kind, int index) {
+
+    bitFrames.insert(bitFrames.end(), bitState.begin(), bitState.end());
+    bitFrames.push_back(formulaHash);
+    bitFrames.push_back(numActiveVars);
+    bitFrames.push_back(numActiveClauses);
+    bitFrames.push_back(UNSATclauseExists);
+    
+    trailEntry entry;
+    entry.kind = kind;
+    entry.index = index;
+    trail.push_back(entry);
+}
+
+/***************************************************************************
+ Function:  bitUndo
+ Inputs:    trail size to go back to
+ Returns:   none
+ Description:   the bitset engine's undoChanges: the frame of the oldest
+                entry being undone is the state before all of them
+ ***************************************************************************/
+void formulaState::bitUndo(unsigned int level) {
+
+    STATS_PHASE(PHASE_UNDO);
+    if (trail.size() <= level) {
+        return;
+    }
+    
+    size_t size = bitState.size();
+    const unsigned long long* frame = &bitFrames[level * (size + BITSET_FRAME_COUNTS)];
+    copy(frame, frame + size, bitState.begin());
+    formulaHash = frame[size];
+    numActiveVars = (int)frame[size + 1];
+    numActiveClauses = (int)frame[size + 2];
+    UNSATclauseExists = frame[size + 3] != 0;
+    
+    trail.resize(level);
+    bitFrames.resize(level * (size + BITSET_FRAME_COUNTS));
+}
+
+/***************************************************************************
+ Function:  setVariable
+ Inputs:    policy of the algorithm being run (template), variable and the
+            value assigned to it
+ Returns:   none
+ Description:   assigns the variable with the policy's engine
+ ***************************************************************************/
+template <class policy>
+void formulaState::setVariable(int variable, int value) {
+
+    if (policy::words) {
+        bitAssign<policy::words>(variable, value);
+    }
+    else {
+        updateClausesAndVariables(variable, value);
+    }
+}
+
+/***************************************************************************
+ Function:  undoTo
+ Inputs:    policy of the algorithm being run (template), trail size to go
+            back to
+ Returns:   none
+ Description:   undoes the changes with the policy's engine
+ ***************************************************************************/
+template <class policy>
+void formulaState::undoTo(unsigned int level) {
+
+    if (policy::words) {
+        bitUndo(level);
+    }
+    else {
+        undoChanges(level);
+    }
+}
+
+/***************************************************************************
+ Function:  clearQueues
+ Inputs:    none
+ Returns:   none
+ Description:   empties the unit and pure queues of both engines
+ ***************************************************************************/
+void formulaState::clearQueues() {
+
+    unitQueue.clear();
+    pureQueue.clear();
+    fill(bitUnits.begin(), bitUnits.end(), 0ULL);
+    fill(bitPures.begin(), bitPures.end(), 0ULL);
+}
+
+/***************************************************************************
+ Function:  bitAssign
+ Inputs:    words of a variable mask (template), variable and the value
+            assigned to it
+ Returns:   none
+ Description:   the bitset engine's updateClausesAndVariables, with the same
+                effect on the formula, its hash and the queues. The clauses
+                the literal is true in are taken out of the active mask a
+                word at a time; the variables they held are then checked
+                against the clauses left, so a variable that dropped out of
+                every clause of one sign is found without any counts
+ ***************************************************************************/
+template <int W>
+void formulaState::bitAssign(int variable, int value) {
+
+    STATS_PHASE(PHASE_UPDATE);
+    bitSave(TRAIL_ASSIGNED, variable);
+    
+    unsigned long long* assigned = &bitState[0];
+    unsigned long long* active = &bitState[W];
+    unsigned long long* positive = &bitState[2 * W];
+    unsigned long long* negative = &bitState[3 * W];
+    unsigned long long* clauses = &bitState[4 * W];
+    
+    //variable becomes inactive
+    int word = (variable - 1) / WORD_BITS;
+    unsigned long long varBit = 1ULL << ((variable - 1) % WORD_BITS);
+    assigned[word] |= varBit;
+    active[word] &= ~varBit;
+    positive[word] &= ~varBit;
+    negative[word] &= ~varBit;
+    numActiveVars--;
+    formulaHash ^= zobrist[numClauses + variable];
+    
+    const unsigned long long* trueIn = &(value == POSITIVE ? bitPositiveIn : bitNegativeIn)[variable * clauseWords];
+    const unsigned long long* falseIn = &(value == POSITIVE ? bitNegativeIn : bitPositiveIn)[variable * clauseWords];
+    
+    //the unassigned variables of the clauses that become satisfied
+    unsigned long long touched[BITSET_MAX_WORDS] = {0};
+    
+    for (int w = 0; w < clauseWords; w++) {
+        
+        //the falsely assigned literal no longer counts in the clause
+        unsigned long long shrunk = falseIn[w] & clauses[w];
+        while (shrunk) {
+            int c = w * WORD_BITS + __builtin_ctzll(shrunk);
+            shrunk &= shrunk - 1;
+            int size = bitClauseSize<W>(c);
+            if (size == 0) {
+                UNSATclauseExists = true;
+            }
+            else if (size == UNIT_SIZE) {
+                bitUnits[c / WORD_BITS] |= 1ULL << (c % WORD_BITS);
+            }
+        }
+        
+        //remove clauses that have the true-value variables
+        unsigned long long satisfied = trueIn[w] & clauses[w];
+        clauses[w] &= ~satisfied;
+        numActiveClauses -= __builtin_popcountll(satisfied);
+        while (satisfied) {
+            int c = w * WORD_BITS + __builtin_ctzll(satisfied);
+            satisfied &= satisfied - 1;
+            formulaHash ^= zobrist[c];
+            for (int i = 0; i < W; i++) {
+                touched[i] |= bitPositive[c * W + i] | bitNegative[c * W + i];
+            }
+        }
+    }
+    
+    for (int i = 0; i < W; i++) {
+        unsigned long long left = touched[i] & active[i];
+        while (left) {
+            int bit = __builtin_ctzll(left);
+            left &= left - 1;
+            int v = i * WORD_BITS + bit + 1;
+            unsigned long long mask = 1ULL << bit;
+            
+            //is it still in an active clause of either sign
+            bool inPositive = false;
+            bool inNegative = false;
+            for (int w = 0; w < clauseWords; w++) {
+                inPositive |= (bitPositiveIn[v * clauseWords + w] & clauses[w]) != 0;
+                inNegative |= (bitNegativeIn[v * clauseWords + w] & clauses[w]) != 0;
+            }
+            bool lostSign = ((positive[i] & mask) && !inPositive) || ((negative[i] & mask) && !inNegative);
+            if (!inPositive) {
+                positive[i] &= ~mask;
+            }
+            if (!inNegative) {
+                negative[i] &= ~mask;
+            }
+            
+            //if v is in no other active clause then it becomes inactive
+            if (!inPositive && !inNegative) {
+                active[i] &= ~mask;
+                numActiveVars--;
+                formulaHash ^= zobrist[numClauses + v];
+            }
+            
+            //otherwise it may now be pure in the remaining clauses
+            else if (lostSign && (bitChoice[i] & mask)) {
+                bitPures[i] |= mask;
+            }
+        }
+    }
+}
+
+/***************************************************************************
+ Function:  bitClauseSize
+ Inputs:    words of a variable mask (template), clause
+ Returns:   number of literals of the clause that are not false
+ Description:   popcount of its unassigned variables
+ ***************************************************************************/
+template <int W>
+int formulaState::bitClauseSize(int clause) {
+
+    const unsigned long long* assigned = &bitState[0];
+    int size = 0;
+    for (int i = 0; i < W; i++) {
+        size += __builtin_popcountll((bitPositive[clause * W + i] | bitNegative[clause * W + i]) & ~assigned[i]);
+    }
+    return size;
+}
+
+/***************************************************************************
+ Function:  bitPropagate
+ Inputs:    words of a variable mask (template)
+ Returns:   product of the probabilities of the chance variables it assigned
+ Description:   the bitset engine's propagateUnits: the lowest clause of the
+                unit mask first, until no unit is left or the node is decided
+ ***************************************************************************/
+template <int W>
+double formulaState::bitPropagate() {
+
+    STATS_PHASE(PHASE_UCP);
+    double probability = SUCCESS;
+    const unsigned long long* assigned = &bitState[0];
+    const unsigned long long* clauses = &bitState[4 * W];
+    
+    int w = 0;
+    while (w < clauseWords) {
+        if (bitUnits[w] == 0) {
+            w++;
+            continue;
+        }
+        int c = w * WORD_BITS + __builtin_ctzll(bitUnits[w]);
+        bitUnits[w] &= bitUnits[w] - 1;
+        
+        //the clause may have been satisfied since it was queued
+        if (!(clauses[w] & (1ULL << (c % WORD_BITS))) || bitClauseSize<W>(c) != UNIT_SIZE) {
+            continue;
+        }
+        
+        //updating total number of UCP
+        ++numUCP;
+        
+        //the only literal of the clause whose variable is not assigned yet
+        int v = INVALID;
+        int value = POSITIVE;
+        for (int i = 0; i < W && v == INVALID; i++) {
+            unsigned long long free = (bitPositive[c * W + i] | bitNegative[c * W + i]) & ~assigned[i];
+            if (free) {
+                v = i * WORD_BITS + __builtin_ctzll(free) + 1;
+                value = (bitPositive[c * W + i] & free) ? POSITIVE : NEGATIVE;
+            }
+        }
+        
+        bitAssign<W>(v, value);
+        
+        if (quantifier[v] != CHOICE_VALUE) {
+            probability *= (value == NEGATIVE) ? (1 - quantifier[v]) : quantifier[v];
+        }
+        
+        //stop as soon as the node would be decided anyway
+        if (numActiveClauses == 0 || UNSATclauseExists || numActiveVars == 0) {
+            break;
+        }
+        
+        //the assignment may have made units in lower clauses
+        w = 0;
+    }
+    
+    return probability;
+}
+
+/***************************************************************************
+ Function:  bitEliminate
+ Inputs:    words of a variable mask (template)
+ Returns:   none
+ Description:   the bitset engine's eliminatePureChoices: the lowest variable
+                of the pure mask first, until none is left or the formula
+                is decided
+ ***************************************************************************/
+template <int W>
+void formulaState::bitEliminate() {
+
+    STATS_PHASE(PHASE_PVE);
+    const unsigned long long* active = &bitState[W];
+    const unsigned long long* positive = &bitState[2 * W];
+    const unsigned long long* negative = &bitState[3 * W];
+    
+    int i = 0;
+    while (i < W) {
+        if (bitPures[i] == 0) {
+            i++;
+            continue;
+        }
+        unsigned long long mask = bitPures[i] & -bitPures[i];
+        bitPures[i] &= bitPures[i] - 1;
+        int v = i * WORD_BITS + __builtin_ctzll(mask) + 1;
+        
+        //the variable may have been assigned or deactivated since it was queued
+        if (!(active[i] & mask) || ((positive[i] & mask) && (negative[i] & mask))) {
+            continue;
+        }
+        
+        //updating total number of PVE
+        ++numPVE;
+        
+        //a variable that is in no active clause counts as pure positive
+        bitAssign<W>(v, (negative[i] & mask) ? NEGATIVE : POSITIVE);
+        
+        //stop as soon as the node would be decided anyway
+        if (numActiveClauses == 0 || numActiveVars == 0) {
+            break;
+        }
+        
+        //the assignment may have made lower variables pure
+        i = 0;
+    }
+}
+
+/***************************************************************************
+ Function:  bitSyncKey
+ Inputs:    words of a variable mask (template)
+ Returns:   none
+ Description:   writes the active clauses and variables into formulaKey, in
+                the clause arena's layout so that the cache works the same.
+                The hash is kept up to date by every change, the key only
+                when it is needed
+ ***************************************************************************/
+template <int W>
+void formulaState::bitSyncKey() {
+
+    const unsigned long long* active = &bitState[W];
+    const unsigned long long* clauses = &bitState[4 * W];
+    
+    copy(clauses, clauses + clauseWords, formulaKey.begin());
+    fill(formulaKey.begin() + clauseWords, formulaKey.end(), 0ULL);
+    
+    //variable v is key bit numClauses + v and mask bit v - 1
+    for (int i = 0; i < W; i++) {
+        int bit = numClauses + 1 + i * WORD_BITS;
+        int word = bit / WORD_BITS;
+        int shift = bit % WORD_BITS;
+        if (word < (int)formulaKey.size()) {
+            formulaKey[word] |= active[i] << shift;
+        }
+        if (shift > 0 && word + 1 < (int)formulaKey.size()) {
+            formulaKey[word + 1] |= active[i] >> (WORD_BITS - shift);
+        }
+    }
+}
+
+/***************************************************************************
+ Function:  bitFirstVar
+ Inputs:    words of a variable mask (template)
+ Returns:   the lowest active variable, INVALID if none
+ Description:   the bitset engine's unassigned_var
+ ***************************************************************************/
+template <int W>
+int formulaState::bitFirstVar() {
+
+    const unsigned long long* active = &bitState[W];
+    for (int i = 0; i < W; i++) {
+        if (active[i]) {
+            return i * WORD_BITS + __builtin_ctzll(active[i]) + 1;
+        }
+    }
+    return INVALID;
+}
+
+/***************************************************************************
+ Function:  bitScoredVar
+ Inputs:    words of a variable mask (template)
+ Returns:   int (variable)
+ Description:   the bitset engine's scoredSH: the best score of the currently
+                active block, lowest variable on ties, scored from the masks.
+                The sizes of the active clauses are counted once per split
+ ***************************************************************************/
+template <int W>
+int formulaState::bitScoredVar() {
+
+    const unsigned long long* active = &bitState[W];
+    const unsigned long long* clauses = &bitState[4 * W];
+    
+    if (trackSizes) {
+        for (int w = 0; w < clauseWords; w++) {
+            unsigned long long left = clauses[w];
+            while (left) {
+                int c = w * WORD_BITS + __builtin_ctzll(left);
+                left &= left - 1;
+                bitSizes[c] = bitClauseSize<W>(c);
+            }
+        }
+    }
+    
+    //the first block with an active variable
+    int block = -1;
+    for (int b = 0; b < numBlocks && block < 0; b++) {
+        for (int i = 0; i < W; i++) {
+            if (bitBlock[b * W + i] & active[i]) {
+                block = b;
+            }
+        }
+    }
+    
+    int best = INVALID;
+    int bestScore = NO_SCORE;
+    while (block >= 0) {
+        for (int i = 0; i < W; i++) {
+            unsigned long long left = bitBlock[block * W + i] & active[i];
+            while (left) {
+                int v = i * WORD_BITS + __builtin_ctzll(left);
+                left &= left - 1;
+                v++;
+                
+                int value = 0;
+                int bound = 0;
+                for (int w = 0; w < clauseWords; w++) {
+                    unsigned long long positiveIn = bitPositiveIn[v * clauseWords + w] & clauses[w];
+                    unsigned long long negativeIn = bitNegativeIn[v * clauseWords + w] & clauses[w];
+                    if (!trackSizes) {
+                        value += __builtin_popcountll(positiveIn) + __builtin_popcountll(negativeIn);
+                        continue;
+                    }
+                    unsigned long long in = positiveIn | negativeIn;
+                    while (in) {
+                        int size = bitSizes[w * WORD_BITS + __builtin_ctzll(in)];
+                        in &= in - 1;
+                        if (bound == 0 || (scoreKind == SCORE_LARGEST_CLAUSE ? size > bound : size < bound)) {
+                            bound = size;
+                        }
+                    }
+                }
+                if (trackSizes) {
+                    value = (bound == 0) ? NO_SCORE : (scoreKind == SCORE_LARGEST_CLAUSE ? bound : -bound);
+                }
+                
+                if (best == INVALID || value > bestScore) {
+                    best = v;
+                    bestScore = value;
+                }
+            }
+        }
+        
+        //the next block that is part of the current block
+        int next = -1;
+        for (int b = block + 1; b < numBlocks && next < 0; b++) {
+            for (int i = 0; i < W && next < 0; i++) {
+                if (bitBlock[b * W + i] & active[i]) {
+                    next = blockChoice[b] == blockChoice[block] ? b : numBlocks;
+                }
+            }
+        }
+        block = (next < numBlocks) ? next : -1;
+    }
+    
+    //no active clause left in the block
+    if (best != INVALID && bestScore == NO_SCORE) {
+        return INVALID;
+    }
+    
+    return best;
+}
+
+/***************************************************************************
+ Function:  bitLeaf
+ Inputs:    words of a variable mask (template)
+ Returns:   probability of the current formula, exact
+ Description:   the bitset engine's solveLeaf, reading the variables and
+                literals off the masks
+ ***************************************************************************/
+template <int W>
+double formulaState::bitLeaf() {
+
+    ++numLeafSolves;
+    const unsigned long long* active = &bitState[W];
+    const unsigned long long* positive = &bitState[2 * W];
+    const unsigned long long* negative = &bitState[3 * W];
+    const unsigned long long* clauses = &bitState[4 * W];
+    
+    //the variables still in a clause; the others cannot change the value
+    unsigned long long present[BITSET_MAX_WORDS];
+    leafVars.clear();
+    leafBit.resize(numVars + 1);
+    for (int i = 0; i < W; i++) {
+        present[i] = active[i] & (positive[i] | negative[i]);
+        unsigned long long left = present[i];
+        while (left) {
+            int v = i * WORD_BITS + __builtin_ctzll(left) + 1;
+            left &= left - 1;
+            leafBit[v] = leafVars.size();
+            leafVars.push_back(v);
+        }
+    }
+    int words = (leafVars.size() > 6) ? 1 << (leafVars.size() - 6) : 1;
+    
+    //AND of the tables of the active clauses
+    leafTable.assign(words, ~0ULL);
+    leafClause.resize(words);
+    for (int w = 0; w < clauseWords; w++) {
+        unsigned long long left = clauses[w];
+        while (left) {
+            int c = w * WORD_BITS + __builtin_ctzll(left);
+            left &= left - 1;
+            fill(leafClause.begin(), leafClause.begin() + words, 0ULL);
+            for (int i = 0; i < W; i++) {
+                unsigned long long literals = bitPositive[c * W + i] & present[i];
+                while (literals) {
+                    addLeafLiteral(leafBit[i * WORD_BITS + __builtin_ctzll(literals) + 1], true, words);
+                    literals &= literals - 1;
+                }
+                literals = bitNegative[c * W + i] & present[i];
+                while (literals) {
+                    addLeafLiteral(leafBit[i * WORD_BITS + __builtin_ctzll(literals) + 1], false, words);
+                    literals &= literals - 1;
+                }
+            }
+            if (!andLeafClause(words)) {
+                return FAILURE;
+            }
+        }
+    }
+    
+    return foldLeaf();
+}
+
+/***************************************************************************
+ Function:  bitFindComponents
+ Inputs:    words of a variable mask (template), frame of the current
+            formula
+ Returns:   true if the formula falls apart into independent components
+ Description:   the bitset engine's findComponents. The clause and variable
+                masks of every component go on bitScratch
+ ***************************************************************************/
+template <int W>
+bool formulaState::bitFindComponents(searchFrame &frame) {
+
+    const unsigned long long* active = &bitState[W];
+    const unsigned long long* positive = &bitState[2 * W];
+    const unsigned long long* negative = &bitState[3 * W];
+    
+    //start from the lowest variable that is still in a clause
+    unsigned long long unlabeled[BITSET_MAX_WORDS];
+    int start = INVALID;
+    for (int i = W - 1; i >= 0; i--) {
+        unlabeled[i] = active[i] & (positive[i] | negative[i]);
+        if (unlabeled[i]) {
+            start = i * WORD_BITS + __builtin_ctzll(unlabeled[i]) + 1;
+        }
+    }
+    if (start == INVALID) {
+        return false;
+    }
+    
+    //the usual case: everything is reachable from the first variable
+    unsigned int base = bitScratch.size();
+    unsigned int stride = clauseWords + W;
+    if (bitLabel<W>(start, base) == numActiveClauses) {
+        bitScratch.resize(base);
+        return false;
+    }
+    
+    ++numComponentSplits;
+    
+    //label the other components, lowest first variable first; nested splits
+    //push above this part
+    unsigned int count = 1;
+    for (int i = 0; i < W; i++) {
+        unlabeled[i] &= ~bitScratch[base + clauseWords + i];
+    }
+    for (int i = 0; i < W; i++) {
+        while (unlabeled[i]) {
+            int v = i * WORD_BITS + __builtin_ctzll(unlabeled[i]) + 1;
+            unsigned int at = base + count * stride;
+            bitLabel<W>(v, at);
+            count++;
+            for (int j = i; j < W; j++) {
+                unlabeled[j] &= ~bitScratch[at + clauseWords + j];
+            }
+        }
+    }
+    frame.scratch = base;
+    frame.numComponents = count;
+    
+    return true;
+}
+
+/***************************************************************************
+ Function:  bitEnterComponent
+ Inputs:    words of a variable mask (template), frame whose components
+            were found
+ Returns:   none
+ Description:   masks the active clauses and variables with those of the
+                frame's current component, as one change on the trail
+ ***************************************************************************/
+template <int W>
+void formulaState::bitEnterComponent(searchFrame &frame) {
+
+    unsigned long long* active = &bitState[W];
+    unsigned long long* clauses = &bitState[4 * W];
+    bitSave(TRAIL_SET_ASIDE, frame.component);
+    
+    //set aside every clause and variable that is not in this component
+    const unsigned long long* component = &bitScratch[frame.scratch + frame.component * (clauseWords + W)];
+    for (int w = 0; w < clauseWords; w++) {
+        unsigned long long aside = clauses[w] & ~component[w];
+        clauses[w] &= component[w];
+        numActiveClauses -= __builtin_popcountll(aside);
+        while (aside) {
+            formulaHash ^= zobrist[w * WORD_BITS + __builtin_ctzll(aside)];
+            aside &= aside - 1;
+        }
+    }
+    for (int i = 0; i < W; i++) {
+        
+        //variables in no clause are in no component and are set aside for all of them
+        unsigned long long aside = active[i] & ~component[clauseWords + i];
+        active[i] &= component[clauseWords + i];
+        numActiveVars -= __builtin_popcountll(aside);
+        while (aside) {
+            formulaHash ^= zobrist[numClauses + i * WORD_BITS + __builtin_ctzll(aside) + 1];
+            aside &= aside - 1;
+        }
+    }
+}
+
+/***************************************************************************
+ Function:  bitLabel
+ Inputs:    words of a variable mask (template), a variable that is in an
+            active clause, where on bitScratch its component goes
+ Returns:   number of active clauses in the variable's component
+ Description:   writes the masks of the active clauses and unassigned
+                variables reachable from the variable through active
+                clauses at that place on bitScratch
+ ***************************************************************************/
+template <int W>
+int formulaState::bitLabel(int start, unsigned int at) {
+
+    const unsigned long long* active = &bitState[W];
+    const unsigned long long* clauses = &bitState[4 * W];
+    
+    bitScratch.resize(at + clauseWords + W);
+    unsigned long long* reachedClauses = &bitScratch[at];
+    unsigned long long* reachedVars = &bitScratch[at + clauseWords];
+    fill(reachedClauses, reachedClauses + clauseWords + W, 0ULL);
+    
+    unsigned long long waiting[BITSET_MAX_WORDS] = {0};
+    waiting[(start - 1) / WORD_BITS] = 1ULL << ((start - 1) % WORD_BITS);
+    reachedVars[(start - 1) / WORD_BITS] = waiting[(start - 1) / WORD_BITS];
+    
+    int reached = 0;
+    int i = 0;
+    while (i < W) {
+        if (waiting[i] == 0) {
+            i++;
+            continue;
+        }
+        int v = i * WORD_BITS + __builtin_ctzll(waiting[i]) + 1;
+        waiting[i] &= waiting[i] - 1;
+        
+        for (int w = 0; w < clauseWords; w++) {
+            unsigned long long found = (bitPositiveIn[v * clauseWords + w] | bitNegativeIn[v * clauseWords + w]) &
+                                       clauses[w] & ~reachedClauses[w];
+            reachedClauses[w] |= found;
+            reached += __builtin_popcountll(found);
+            while (found) {
+                int c = w * WORD_BITS + __builtin_ctzll(found);
+                found &= found - 1;
+                for (int j = 0; j < W; j++) {
+                    unsigned long long next = (bitPositive[c * W + j] | bitNegative[c * W + j]) &
+                                              active[j] & ~reachedVars[j];
+                    reachedVars[j] |= next;
+                    waiting[j] |= next;
+                }
+            }
+        }
+        i = 0;
+    }
+    
+    return reached;
+}
+
+/***************************************************************************/
+/* PARALLEL SEARCH */
+
+/***************************************************************************
+ Function:  offerTask
+ Inputs:    variable to set to TRUE, window of the subtree
+ Returns:   the task, which the split gives back with releaseTask
+ Description:   puts the subtree of setting the variable to TRUE at the back
+                of this thread's task queue, where idle threads can take it.
+                The path to it is every assignment and set-aside on the trail
+                (the other entries follow from those) and the new assignment.
+                Splits end in the opposite order they offer in, so the
+                thread's tasks are taken and given back as a stack
+ ***************************************************************************/
+splitTask* formulaState::offerTask(int variable, double low, double high) {
+
+    searchWorker* owner = context->workers[worker];
+    if (owner->numOffered == owner->offered.size()) {
+        owner->offered.emplace_back();
+    }
+    splitTask* task = &owner->offered[owner->numOffered++];
+    task->path.clear();
+    
+    trailEntry step;
+    for (unsigned int t = 0; t < trail.size(); t++) {
+        step = trail[t];
+        if (step.kind == TRAIL_ASSIGNED) {
+            step.index *= assignment[step.index];
+            task->path.push_back(step);
+        }
+        else if (step.kind == TRAIL_SET_ASIDE || step.kind == TRAIL_VAR_SET_ASIDE) {
+            task->path.push_back(step);
+        }
+    }
+    step.kind = TRAIL_ASSIGNED;
+    step.index = variable * POSITIVE;
+    task->path.push_back(step);
+    
+    task->low = low;
+    task->high = high;
+    task->done = false;
+    
+    {
+        lock_guard<mutex> guard(owner->tasksLock);
+        owner->tasks.push_back(task);
+        context->numOpenTasks++;
+    }
+    context->wakeWorkers();
+    return task;
+}
+
+/***************************************************************************
+ Function:  releaseTask
+ Inputs:    none
+ Returns:   none
+ Description:   gives back the last task this thread offered, once it was
+                reclaimed or its thief is done with it
+ ***************************************************************************/
+void formulaState::releaseTask() {
+
+    context->workers[worker]->numOffered--;
+}
+
+/***************************************************************************
+ Function:  reclaimTask
+ Inputs:    task offered by this state
+ Returns:   true if no other thread took the task
+ Description:   takes the task back from this thread's queue. Tasks offered
+                deeper in the search were reclaimed or taken before, so an
+                untaken task is always at the back
+ ***************************************************************************/
+bool formulaState::reclaimTask(splitTask* task) {
+
+    searchWorker* owner = context->workers[worker];
+    lock_guard<mutex> guard(owner->tasksLock);
+    if (!owner->tasks.empty() && owner->tasks.back() == task) {
+        owner->tasks.pop_back();
+        context->numOpenTasks--;
+        return true;
+    }
+    return false;
+}
+
+/***************************************************************************
+ Function:  joinTask
+ Inputs:    task taken by another thread
+ Returns:   probability of the task's subtree
+ Description:   waits until the thread that took the task has solved it,
+                working on subtrees stolen from other threads in the
+                meantime, each in a new formula state of this thread, and
+                sleeping while there is none
+ ***************************************************************************/
+double formulaState::joinTask(splitTask* task) {
+
+    context->numIdleWorkers++;
+    bool canSteal = (depth + 1 < MAX_HELP_DEPTH);
+    while (!task->done) {
+        if (!canSteal || !context->stealTask(worker, depth + 1)) {
+            context->waitForWork(task, canSteal);
+        }
+    }
+    context->numIdleWorkers--;
+    
+    if (!task->exact) {
+        ++numBoundJoins;
+    }
+    return task->probability;
+}
+
+/***************************************************************************
+ Function:  runTask
+ Inputs:    task taken from another thread
+ Returns:   none
+ Description:   replays the task's path on this state, which is at the
+                root, solves the subtree and goes back to the root
+ ***************************************************************************/
+void formulaState::runTask(splitTask* task) {
+
+    ++numStolenTasks;
+    
+    //everything but the split itself, whose units and pure variables the
+    //subtree starts from like the owner's TRUE branch does
+    for (unsigned int t = 0; t + 1 < task->path.size(); t++) {
+        trailEntry step = task->path[t];
+        if (step.kind == TRAIL_ASSIGNED) {
+            updateClausesAndVariables(abs(step.index), step.index > 0 ? POSITIVE : NEGATIVE);
+        }
+        else if (step.kind == TRAIL_SET_ASIDE) {
+            setAsideClause(step.index);
+        }
+        else {
+            setAsideVariable(step.index);
+        }
+    }
+    clearQueues();
+    int split = task->path.back().index;
+    updateClausesAndVariables(abs(split), split > 0 ? POSITIVE : NEGATIVE);
+    
+    int boundsBefore = numInexact();
+    task->probability = (this->*context->kernel)(task->low, task->high);
+    task->exact = numInexact() == boundsBefore;
+    
+    undoChanges(0);
+    
+    //the owner may return as soon as this is set, taking the task with it
+    task->done = true;
+    context->wakeWorkers();
+}
+
+/***************************************************************************
+ Function:  waitForWork
+ Inputs:    task the thread is waiting for (NULL for none), whether it may
+            take another one
+ Returns:   none
+ Description:   sleeps until the task is solved, a task the thread may take
+                is offered or the search is finished, instead of spinning.
+                Counting itself in numSleeping before it looks makes sure
+                wakeWorkers either sees it or happened before the check
+ ***************************************************************************/
+void solverContext::waitForWork(const splitTask* joined, bool canSteal) {
+
+    unique_lock<mutex> guard(idleLock);
+    numSleeping++;
+    while (!searchFinished && !(joined != NULL && joined->done) && !(canSteal && numOpenTasks > 0)) {
+        workChanged.wait(guard);
+    }
+    numSleeping--;
+}
+
+/***************************************************************************
+ Function:  wakeWorkers
+ Inputs:    none
+ Returns:   none
+ Description:   wakes the sleeping threads after a task was offered or
+                solved or the search finished, so they look again
+ ***************************************************************************/
+void solverContext::wakeWorkers() {
+
+    if (numSleeping > 0) {
+        lock_guard<mutex> guard(idleLock);
+        workChanged.notify_all();
+    }
+}
+
+/***************************************************************************
+ Function:  stealTask
+ Inputs:    thread looking for work, which of its states to use
+ Returns:   true if a task was found and solved
+ Description:   takes the oldest task of the first thread that has one (the
+                oldest is the closest to the root, so it is the largest) and
+                solves it
+ ***************************************************************************/
+bool solverContext::stealTask(int worker, unsigned int depth) {
+
+    if (numOpenTasks == 0) {
+        return false;
+    }
+    
+    splitTask* task = NULL;
+    for (int i = 0; i < numThreads && task == NULL; i++) {
+        searchWorker* victim = workers[(worker + i) % numThreads];
+        lock_guard<mutex> guard(victim->tasksLock);
+        if (!victim->tasks.empty()) {
+            task = victim->tasks.front();
+            victim->tasks.pop_front();
+            numOpenTasks--;
+        }
+    }
+    if (task == NULL) {
+        return false;
+    }
+    
+    numIdleWorkers--;
+    workerState(worker, depth)->runTask(task);
+    numIdleWorkers++;
+    return true;
+}
+
+/***************************************************************************
+ Function:  workerLoop
+ Inputs:    thread
+ Returns:   none
+ Description:   body of a helper thread: steals and solves subtrees until
+                the search is over
+ ***************************************************************************/
+void solverContext::workerLoop(int worker) {
+
+#ifdef SSAT_STATS
+    unsigned long long eventStart[NUM_HW_EVENTS], eventEnd[NUM_HW_EVENTS];
+    bool counting = perfEnabled && readEvents(eventStart);
+    unsigned long long allocationsStart = heapAllocations;
+#endif
+    
+    numIdleWorkers++;
+    while (!searchFinished) {
+        if (!stealTask(worker, 0)) {
+            waitForWork(NULL, true);
+        }
+    }
+    numIdleWorkers--;
+    
+#ifdef SSAT_STATS
+    workerState(worker, 0)->searchAllocations += heapAllocations - allocationsStart;
+    if (counting && readEvents(eventEnd)) {
+        addEvents(workerState(worker, 0)->searchEvents, eventStart, eventEnd);
+    }
+#endif
+}
+
+/***************************************************************************
+ Function:  workerState
+ Inputs:    thread, how many of its searches are waiting below this one
+ Returns:   the thread's formula state for that depth
+ Description:   states are copied from the initial state the first time
+                they are needed and kept for later runs
+ ***************************************************************************/
+formulaState* solverContext::workerState(int worker, unsigned int depth) {
+
+    vector<formulaState*> &states = workers[worker]->states;
+    while (states.size() <= depth) {
+        formulaState* state = new formulaState(*instance->initialState);
+        state->trail.reserve(instance->initialState->trail.capacity());
+        state->frames.reserve(instance->initialState->frames.capacity());
+        state->bitFrames.reserve(instance->initialState->bitFrames.capacity());
+        state->reserveScratch();
+        state->cache = &workers[worker]->cache;
+        state->context = this;
+        state->trackBlocks = (algorithm > UCPPVE);
+        state->initScores(SCORE_KINDS[algorithm]);
+        state->worker = worker;
+        state->depth = states.size();
+        state->resetResult();
+        seed_seq sequence = {seed, (unsigned int)worker, state->depth};
+        state->random.seed(sequence);
+        states.push_back(state);
+    }
+    return states[depth];
+}
+
+/***************************************************************************
+ Function:  solverContext
+ Inputs:    none
+ Returns:   none
+ Description:   a run with no threads yet, seeded with the --seed given
+ ***************************************************************************/
+solverContext::solverContext() : instance(NULL), algorithm(NAIVE), seed(randomSeed), bitset(false) {
+}
+
+/***************************************************************************
+ Function:  ~solverContext
+ Inputs:    none
+ Returns:   none
+ Description:   frees the threads' formula states and caches
+ ***************************************************************************/
+solverContext::~solverContext() {
+
+    for (unsigned int w = 0; w < workers.size(); w++) {
+        for (unsigned int d = 0; d < workers[w]->states.size(); d++) {
+            delete workers[w]->states[d];
+        }
+        delete workers[w];
+    }
+}
+
+/***************************************************************************
+ Function:  startWorkers
+ Inputs:    none
+ Returns:   none
+ Description:   gets every thread ready for a new run: counters reset, caches
+                emptied, random choices seeded again, and the helper threads
+                started. Every state gets its own stream of the run's seed,
+                so a run on one thread always makes the same choices
+ ***************************************************************************/
+void solverContext::startWorkers() {
+
+    while ((int)workers.size() < numThreads) {
+        workers.push_back(new searchWorker());
+    }
+    
+    for (int w = 0; w < numThreads; w++) {
+        
+        //the memory cap is for all threads together
+        initCache(workers[w]->cache, instance->initialState->formulaKey.size(),
+                  cacheMegabytes / numThreads);
+        workerState(w, 0);
+        for (unsigned int d = 0; d < workers[w]->states.size(); d++) {
+            workers[w]->states[d]->resetResult();
+            seed_seq sequence = {seed, (unsigned int)w, d};
+            workers[w]->states[d]->random.seed(sequence);
+        }
+    }
+    workerState(0, 0)->initQueues();
+    
+    numIdleWorkers = 0;
+    numOpenTasks = 0;
+    numSleeping = 0;
+    searchFinished = false;
+    for (int w = 1; w < numThreads; w++) {
+        helperThreads.push_back(thread(&solverContext::workerLoop, this, w));
+    }
+}
+
+/***************************************************************************
+ Function:  stopWorkers
+ Inputs:    none
+ Returns:   none
+ Description:   stops the helper threads once the thread that called solve
+                is done and adds up the counters of every state into totals
+ ***************************************************************************/
+void solverContext::stopWorkers() {
+
+    searchFinished = true;
+    wakeWorkers();
+    for (unsigned int t = 0; t < helperThreads.size(); t++) {
+        helperThreads[t].join();
+    }
+    helperThreads.clear();
+    
+    totals.resetResult();
+    threadNodes.assign(numThreads, 0);
+    for (int w = 0; w < numThreads; w++) {
+        for (unsigned int d = 0; d < workers[w]->states.size(); d++) {
+            totals.addCounters(*workers[w]->states[d]);
+            threadNodes[w] += workers[w]->states[d]->numNodes;
+        }
+    }
+}
+
+/***************************************************************************/
+/* BATCH MODE */
+
+/***************************************************************************
+ Function:  expandInputs
+ Inputs:    file names, directories and glob patterns
+ Returns:   the files they name, in order
+ Description:   a directory stands for the .ssat files in it, and a pattern
+                the shell did not expand is expanded here
+ ***************************************************************************/
+vector<string> expandInputs(const vector<string> &patterns) {
+
+    vector<string> files;
+    for (unsigned int p = 0; p < patterns.size(); p++) {
+        string pattern = patterns[p];
+        struct stat info;
+        if (stat(pattern.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+            pattern += "/*.ssat";
+        }
+        
+        glob_t matches;
+        if (glob(pattern.c_str(), 0, NULL, &matches) == 0) {
+            for (size_t m = 0; m < matches.gl_pathc; m++) {
+                files.push_back(matches.gl_pathv[m]);
+            }
+        }
+        else {
+            //no match, readFile reports it
+            files.push_back(pattern);
+        }
+        globfree(&matches);
+    }
+    return files;
+}
+
+/***************************************************************************
+ Function:  runBatch
+ Inputs:    file names, directories and glob patterns
+ Returns:   false if a file could not be read or an output not opened
+ Description:   reads every instance, then solves it with every selected
+                algorithm on numJobs threads. The longest runs are expected
+                to be the ones with the most variables and clauses, so they
+                start first and the short ones fill in at the end. Every
+                result is written as soon as its run finishes
+ ***************************************************************************/
+bool runBatch(const vector<string> &patterns) {
+
+    batchRun batch;
+    vector<string> files = expandInputs(patterns);
+    bool allRead = true;
+    
+    for (unsigned int f = 0; f < files.size(); f++) {
+        ssatInstance* instance = new ssatInstance();
+        if (!instance->readFile(files[f])) {
+            cerr << "File is not valid: " << files[f] << endl;
+            delete instance;
+            allRead = false;
+            continue;
+        }
+        batch.instances.push_back(instance);
+    }
+    
+    //largest expected number of splits (times the work of one) first
+    vector<pair<double, solverContext*> > order;
+    for (unsigned int i = 0; i < batch.instances.size(); i++) {
+        const ssatInstance* instance = batch.instances[i];
+        for (unsigned int a = 0; a < algorithms.size(); a++) {
+            solverContext* context = new solverContext();
+            context->instance = instance;
+            context->algorithm = algorithms[a];
+            double work = log2((double)instance->db.literals.size() + 1)
+                        + instance->numVars * SPLIT_EXPONENT[algorithms[a]];
+            order.push_back(make_pair(-work, context));
+        }
+    }
+    stable_sort(order.begin(), order.end(),
+                [](const pair<double, solverContext*> &x, const pair<double, solverContext*> &y) {
+                    return x.first < y.first;
+                });
+    for (unsigned int j = 0; j < order.size(); j++) {
+        batch.jobs.push_back(order[j].second);
+    }
+    
+    //json lines if asked for, csv otherwise
+    ofstream outFile;
+    batch.json = !jsonPath.empty();
+    batch.out = &cout;
+    string outPath = batch.json ? jsonPath : csvPath;
+    if (!outPath.empty()) {
+        outFile.open(outPath.c_str());
+        if (!outFile.is_open()) {
+            cerr << "cannot write " << outPath << endl;
+            return false;
+        }
+        batch.out = &outFile;
+    }
+    *batch.out << setprecision(15);
+    batch.writeHeader();
+    
+    batch.nextJob = 0;
+    vector<thread> pool;
+    for (int t = 0; t < min(numJobs, (int)batch.jobs.size()); t++) {
+        pool.push_back(thread(&batchRun::jobLoop, &batch));
+    }
+    for (unsigned int t = 0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+    
+    for (unsigned int i = 0; i < batch.instances.size(); i++) {
+        delete batch.instances[i]->initialState;
+        delete batch.instances[i];
+    }
+    return allRead;
+}
+
+/***************************************************************************
+ Function:  jobLoop
+ Inputs:    none
+ Returns:   none
+ Description:   body of a thread of the batch: runs the next job until there
+                are none left, and frees each one once its result is out
+ ***************************************************************************/
+void batchRun::jobLoop() {
+
+    while (true) {
+        unsigned int j = nextJob++;
+        if (j >= jobs.size()) {
+            return;
+        }
+        jobs[j]->solve();
+        writeResult(*jobs[j]);
+        delete jobs[j];
+        jobs[j] = NULL;
+    }
+}
+
+/***************************************************************************
+ Function:  writeHeader
+ Inputs:    none
+ Returns:   none
+ Description:   names the columns of a csv; json lines need no header
+ ***************************************************************************/
+void batchRun::writeHeader() {
+
+    if (json) {
+        return;
+    }
+    *out << "file,algorithm,variables,clauses,parse_time,threshold,result,lower,upper,"
+         << "ucp,pve,vs,percentage_vs,cache_hits,cache_misses,component_splits,"
+         << "choice_prunes,chance_lower_prunes,chance_upper_prunes,component_prunes,"
+         << "stolen_subtrees,leaf_solves,nodes,time" << endl;
+}
+
+/***************************************************************************
+ Function:  writeResult
+ Inputs:    context of a finished run
+ Returns:   none
+ Description:   writes the run's result and counters (a csv row per
+                threshold, or one json object) and flushes them, so a batch
+                that is stopped keeps everything that finished
+ ***************************************************************************/
+void batchRun::writeResult(solverContext &context) {
+
+    const ssatInstance &instance = *context.instance;
+    const searchCounters &totals = context.totals;
+    string name = ALGORITHM_NAMES[context.algorithm];
+    double percentage = PERCENTAGE * (double)totals.numVS / (pow(2, instance.numVars) - 1);
+    stringstream counters;
+    
+    lock_guard<mutex> guard(outLock);
+    
+    if (json) {
+        string file;
+        for (unsigned int c = 0; c < instance.name.size(); c++) {
+            if (instance.name[c] == '"' || instance.name[c] == '\\') {
+                file += '\\';
+            }
+            file += instance.name[c];
+        }
+        *out << "{\"file\": \"" << file << "\", \"algorithm\": \"" << name << "\", "
+             << "\"variables\": " << instance.numVars << ", \"clauses\": " << instance.numClauses
+             << ", \"parse_time\": " << instance.parseTime << ", ";
+        if (thresholds.empty()) {
+            *out << "\"probability\": " << context.probSAT << ", ";
+        }
+        else {
+            *out << "\"decisions\": [";
+            for (unsigned int t = 0; t < context.decisions.size(); t++) {
+                const thresholdDecision &d = context.decisions[t];
+                *out << (t ? ", " : "") << "{\"threshold\": " << d.threshold
+                     << ", \"satisfied\": " << (d.satisfied ? "true" : "false")
+                     << ", \"lower\": " << d.lower << ", \"upper\": " << d.upper << "}";
+            }
+            *out << "], ";
+        }
+        *out << "\"ucp\": " << totals.numUCP << ", \"pve\": " << totals.numPVE
+             << ", \"vs\": " << totals.numVS << ", \"percentage_vs\": " << percentage
+             << ", \"cache_hits\": " << totals.numCacheHits << ", \"cache_misses\": " << totals.numCacheMisses
+             << ", \"component_splits\": " << totals.numComponentSplits
+             << ", \"choice_prunes\": " << totals.numChoicePrunes
+             << ", \"chance_lower_prunes\": " << totals.numChanceLowerPrunes
+             << ", \"chance_upper_prunes\": " << totals.numChanceUpperPrunes
+             << ", \"component_prunes\": " << totals.numComponentPrunes
+             << ", \"stolen_subtrees\": " << totals.numStolenTasks
+             << ", \"leaf_solves\": " << totals.numLeafSolves
+             << ", \"nodes\": " << totals.numNodes << ", \"time\": " << context.solutionTime << "}" << endl;
+        return;
+    }
+    
+    //the file name is quoted, with its quotes doubled
+    string file = "\"";
+    for (unsigned int c = 0; c < instance.name.size(); c++) {
+        file += instance.name[c];
+        if (instance.name[c] == '"') {
+            file += '"';
+        }
+    }
+    file += "\"";
+    
+    counters << setprecision(15) << totals.numUCP << "," << totals.numPVE << "," << totals.numVS << ","
+             << percentage << "," << totals.numCacheHits << "," << totals.numCacheMisses << ","
+             << totals.numComponentSplits << "," << totals.numChoicePrunes << ","
+             << totals.numChanceLowerPrunes << "," << totals.numChanceUpperPrunes << ","
+             << totals.numComponentPrunes << "," << totals.numStolenTasks << ","
+             << totals.numLeafSolves << ","
+             << totals.numNodes << "," << context.solutionTime;
+    
+    stringstream prefix;
+    prefix << setprecision(15) << file << "," << name << "," << instance.numVars << ","
+           << instance.numClauses << "," << instance.parseTime << ",";
+    if (thresholds.empty()) {
+        *out << prefix.str() << "," << context.probSAT << ",,," << counters.str() << endl;
+    }
+    for (unsigned int t = 0; t < context.decisions.size(); t++) {
+        const thresholdDecision &d = context.decisions[t];
+        *out << prefix.str() << d.threshold << "," << (d.satisfied ? "yes" : "no") << ","
+             << d.lower << "," << d.upper << "," << counters.str() << endl;
+    }
+}
+
+/***************************************************************************/
+/* BENCHMARK */
+
+//the fixed corpus of the benchmark, relative to the directory it is run in
+static const char* BENCH_CORPUS[] = {
+    "newProblems/e1.ssat", "newProblems/e2.ssat", "newProblems/e3.ssat",
+    "newProblems/r1.ssat", "newProblems/r2.ssat", "newProblems/r3.ssat",
+    "newProblems/er1.ssat", "newProblems/er2.ssat", "newProblems/er3.ssat",
+    "newProblems/re1.ssat", "newProblems/re2.ssat", "newProblems/re3.ssat",
+    "newProblems/erer1.ssat", "newProblems/erer2.ssat", "newProblems/erer3.ssat",
+    "newProblems/rere1.ssat", "newProblems/rere2.ssat", "newProblems/rere3.ssat",
+    "oldproblems/small1.ssat", "oldproblems/small2.ssat", "oldproblems/small3.ssat",
+    "oldproblems/small4.ssat", "oldproblems/small5.ssat"
+};
+
+/***************************************************************************
+ Function:  runBench
+ Inputs:    directory the corpus is in
+ Returns:   false if a file of the corpus could not be read or a results
+            file not read or written
+ Description:   solves every instance of BENCH_CORPUS with every selected
+                algorithm, one run at a time: benchWarmup untimed runs, then
+                benchRuns timed ones. Prints the median, 90th percentile and
+                spread ((max - min) / median) of the wall time and the node
+                rate of every job, and how they compare to the results of
+                an earlier benchmark if one is given. The results are
+                written to benchOutPath for later comparisons
+ ***************************************************************************/
+bool runBench(string root) {
+
+    vector<benchResult> baseline;
+    if (!comparePath.empty() && !readBenchFile(comparePath, baseline)) {
+        cout << "cannot read " << comparePath << endl;
+        return false;
+    }
+    
+    ofstream outFile;
+    if (!benchOutPath.empty()) {
+        outFile.open(benchOutPath.c_str());
+        if (!outFile.is_open()) {
+            cout << "cannot write " << benchOutPath << endl;
+            return false;
+        }
+        outFile << setprecision(15);
+        outFile << "instance,algorithm,runs,time_median,time_p90,time_min,time_max,"
+                << "node_rate_median,node_rate_p90,node_rate_min,node_rate_max,nodes,probability" << endl;
+    }
+    
+    double logRatios = 0;
+    int numCompared = 0;
+    int numChanged = 0;
+    
+    for (unsigned int f = 0; f < sizeof(BENCH_CORPUS) / sizeof(BENCH_CORPUS[0]); f++) {
+        ssatInstance instance;
+        if (!instance.readFile(root + "/" + BENCH_CORPUS[f])) {
+            cout << "File is not valid: " << root + "/" + BENCH_CORPUS[f] << endl;
+            return false;
+        }
+        
+        for (unsigned int a = 0; a < algorithms.size(); a++) {
+            solverContext context;
+            context.instance = &instance;
+            context.algorithm = algorithms[a];
+            
+            for (int r = 0; r < benchWarmup; r++) {
+                context.solve();
+            }
+            vector<double> times, rates;
+            for (int r = 0; r < benchRuns; r++) {
+                context.solve();
+                times.push_back(context.solutionTime);
+                rates.push_back(context.totals.numNodes / max(context.solutionTime, 1e-9));
+            }
+            
+            benchResult result;
+            result.instance = BENCH_CORPUS[f];
+            result.algorithm = ALGORITHM_NAMES[algorithms[a]];
+            result.runs = benchRuns;
+            result.timeMedian = percentile(times, 0.5);
+            result.timeP90 = percentile(times, 0.9);
+            result.timeMin = *min_element(times.begin(), times.end());
+            result.timeMax = *max_element(times.begin(), times.end());
+            result.nodeRateMedian = percentile(rates, 0.5);
+            result.nodeRateP90 = percentile(rates, 0.9);
+            result.nodeRateMin = *min_element(rates.begin(), rates.end());
+            result.nodeRateMax = *max_element(rates.begin(), rates.end());
+            result.nodes = context.totals.numNodes;
+            result.probability = context.probSAT;
+            
+            cout << left << setw(26) << result.instance << setw(10) << result.algorithm << right
+                 << " median " << setw(10) << result.timeMedian << "s  p90 " << setw(10) << result.timeP90
+                 << "s  spread " << setw(6) << setprecision(3)
+                 << PERCENTAGE * (result.timeMax - result.timeMin) / max(result.timeMedian, 1e-9) << "%"
+                 << "  nodes/s " << setw(10) << setprecision(6) << result.nodeRateMedian
+                 << "  p90 " << setw(10) << result.nodeRateP90
+                 << "  spread " << setw(6) << setprecision(3)
+                 << PERCENTAGE * (result.nodeRateMax - result.nodeRateMin) / max(result.nodeRateMedian, 1e-9) << "%"
+                 << setprecision(6);
+            
+            //the same job in the earlier results
+            for (unsigned int b = 0; b < baseline.size(); b++) {
+                if (baseline[b].instance == result.instance && baseline[b].algorithm == result.algorithm) {
+                    double ratio = baseline[b].timeMedian / max(result.timeMedian, 1e-9);
+                    cout << "  x" << setprecision(3) << ratio << setprecision(6);
+                    logRatios += log(ratio);
+                    numCompared++;
+                    if (fabs(baseline[b].probability - result.probability) > 1e-9) {
+                        cout << "  PROBABILITY CHANGED (was " << baseline[b].probability << ")";
+                        numChanged++;
+                    }
+                    break;
+                }
+            }
+            cout << endl;
+            
+            if (outFile.is_open()) {
+                outFile << result.instance << "," << result.algorithm << "," << result.runs << ","
+                        << result.timeMedian << "," << result.timeP90 << ","
+                        << result.timeMin << "," << result.timeMax << ","
+                        << result.nodeRateMedian << "," << result.nodeRateP90 << ","
+                        << result.nodeRateMin << "," << result.nodeRateMax << ","
+                        << result.nodes << "," << result.probability << endl;
+            }
+        }
+        delete instance.initialState;
+    }
+    
+    //the geometric mean, so that no single job dominates
+    if (numCompared > 0) {
+        cout << "SPEEDUP OVER " << comparePath << ": x" << setprecision(3) << exp(logRatios / numCompared)
+             << " (geometric mean of the median times of " << numCompared << " jobs)" << endl;
+        if (numChanged > 0) {
+            cout << "PROBABILITY CHANGED IN " << numChanged << " JOBS" << endl;
+        }
+    }
+    return true;
+}
+
+/***************************************************************************
+ Function:  percentile
+ Inputs:    values, fraction of them that must be at most the result
+ Returns:   the nearest-rank percentile of the values
+ Description:   none
+ ***************************************************************************/
+double percentile(vector<double> values, double fraction) {
+
+    sort(values.begin(), values.end());
+    int rank = (int)ceil(fraction * values.size()) - 1;
+    return values[max(0, min(rank, (int)values.size() - 1))];
+}
+
+/***************************************************************************
+ Function:  readBenchFile
+ Inputs:    file written by an earlier benchmark, where to put its lines
+ Returns:   false if the file could not be opened
+ Description:   reads the results back; lines that do not have every column
+                are skipped
+ ***************************************************************************/
+bool readBenchFile(string path, vector<benchResult> &results) {
+
+    ifstream inFile(path.c_str());
+    if (!inFile.is_open()) {
+        return false;
+    }
+    
+    string line;
+    getline(inFile, line);
+    while (getline(inFile, line)) {
+        stringstream columns(line);
+        vector<string> fields;
+        string field;
+        while (getline(columns, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 13) {
+            continue;
+        }
+        
+        benchResult result;
+        result.instance = fields[0];
+        result.algorithm = fields[1];
+        result.runs = atoi(fields[2].c_str());
+        result.timeMedian = atof(fields[3].c_str());
+        result.timeP90 = atof(fields[4].c_str());
+        result.timeMin = atof(fields[5].c_str());
+        result.timeMax = atof(fields[6].c_str());
+        result.nodeRateMedian = atof(fields[7].c_str());
+        result.nodeRateP90 = atof(fields[8].c_str());
+        result.nodeRateMin = atof(fields[9].c_str());
+        result.nodeRateMax = atof(fields[10].c_str());
+        result.nodes = atoll(fields[11].c_str());
+        result.probability = atof(fields[12].c_str());
+        results.push_back(result);
+    }
+    return true;
+}
+
+/***************************************************************************/
+/* SEED SWEEP */
+
+/***************************************************************************
+ Function:  runSweep
+ Inputs:    parsed instance
+ Returns:   false if the seeds did not all find the same probability
+ Description:   solves the instance with RANDOMVAR once for each of the
+                sweepSeeds seeds from randomSeed on, numJobs runs at a time,
+                and prints every run and the distribution of the nodes,
+                variable splits and wall time over the seeds, to tell how
+                much of RANDOMVAR's results is the luck of its choices
+ ***************************************************************************/
+bool runSweep(const ssatInstance &instance) {
+
+    vector<solverContext*> runs;
+    for (int s = 0; s < sweepSeeds; s++) {
+        runs.push_back(new solverContext());
+        runs[s]->instance = &instance;
+        runs[s]->algorithm = RANDOMVAR;
+        runs[s]->seed = randomSeed + s;
+    }
+    
+    atomic<unsigned int> nextRun(0);
+    vector<thread> pool;
+    for (int t = 0; t < min(numJobs, sweepSeeds); t++) {
+        pool.push_back(thread([&runs, &nextRun]() {
+            for (unsigned int r = nextRun++; r < runs.size(); r = nextRun++) {
+                runs[r]->solve();
+            }
+        }));
+    }
+    for (unsigned int t = 0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+    
+    vector<double> nodes, splits, times;
+    bool sameProbability = true;
+    for (unsigned int r = 0; r < runs.size(); r++) {
+        const solverContext &run = *runs[r];
+        cout << "SEED " << run.seed << ": " << run.probSAT << "  nodes " << run.totals.numNodes
+             << "  vs " << run.totals.numVS << "  time " << run.solutionTime << endl;
+        nodes.push_back(run.totals.numNodes);
+        splits.push_back(run.totals.numVS);
+        times.push_back(run.solutionTime);
+        if (fabs(run.probSAT - runs[0]->probSAT) > 1e-9) {
+            sameProbability = false;
+        }
+    }
+    
+    cout << "====================================================================" << endl;
+    cout << "SWEEP OF RANDOMVAR OVER " << runs.size() << " SEEDS FROM " << randomSeed << endl;
+    const vector<double>* values[] = {&nodes, &splits, &times};
+    const char* names[] = {"NODES", "VS", "TIME"};
+    for (int m = 0; m < 3; m++) {
+        const vector<double> &v = *values[m];
+        double mean = 0, deviation = 0;
+        for (unsigned int r = 0; r < v.size(); r++) {
+            mean += v[r] / v.size();
+        }
+        for (unsigned int r = 0; r < v.size(); r++) {
+            deviation += (v[r] - mean) * (v[r] - mean) / v.size();
+        }
+        cout << left << setw(6) << names[m] << right
+             << " min " << *min_element(v.begin(), v.end())
+             << "  median " << percentile(v, 0.5) << "  p90 " << percentile(v, 0.9)
+             << "  max " << *max_element(v.begin(), v.end())
+             << "  mean " << mean << "  stddev " << sqrt(deviation)
+             << "  cv " << setprecision(3) << PERCENTAGE * sqrt(deviation) / max(mean, 1e-9) << "%"
+             << setprecision(6) << endl;
+    }
+    if (!sameProbability) {
+        cout << "PROBABILITY DIFFERS BETWEEN SEEDS" << endl;
+    }
+    cout << "====================================================================" << endl;
+    
+    for (unsigned int r = 0; r < runs.size(); r++) {
+        delete runs[r];
+    }
+    return sameProbability;
+}
+
+/***************************************************************************/
+/* SPLITTING HEURISTICS */
+
+/***************************************************************************
+ Function:  randomSH
+ Inputs:    none
+ Returns:   variable
+ Description: picks a random variable from the currently active block,
+              with the state's own engine so that a seed gives the same run
+ ***************************************************************************/
+int formulaState::randomSH(){
+
+    // if there are no variables to choose from, return
+    if (numActiveVars == 0) {
+        return INVALID;
+    }
+    
+    // counts the variables of the current block
+    int size = 0;
+    for (int b = firstBlock(); b >= 0; b = nextBlock(b)) {
+        size += blockActive[b];
+    }
+
+    // choose a random variable of the block
+    int randNum = uniform_int_distribution<int>(0, size - 1)(random);
+    
+    int b = firstBlock();
+    while (randNum >= blockActive[b]) {
+        randNum -= blockActive[b];
+        b = nextBlock(b);
+    }
+    return blockVars[blockStart[b] + randNum];
+}
+
+/***************************************************************************
+ Function:  scoredSH
+ Inputs:    none
+ Returns:   int (variable)
+ Description:   picks the variable with the best score of the currently
+                active block (the lowest one of those that score as well):
+                the most clauses for MAXVAR, the smallest clause for
+                MINCLAUSE and the largest clause for MAXCLAUSE. It is at
+                the top of its block's heap
+ ***************************************************************************/
+int formulaState::scoredSH() {
+
+    //bring the heaps up to date with the counts
+    for (unsigned int i = 0; i < dirtyVars.size(); i++) {
+        scoreDirty[dirtyVars[i]] = false;
+        rescoreVariable(dirtyVars[i]);
+    }
+    dirtyVars.clear();
+    
+    int best = INVALID;
+    for (int b = firstBlock(); b >= 0; b = nextBlock(b)) {
+        
+        //small blocks are scanned
+        if (heapSize[b] == 0) {
+            for (int i = blockStart[b]; i < blockStart[b] + blockActive[b]; i++) {
+                int v = blockVars[i];
+                score[v] = variableScore(v);
+                if (best == INVALID || betterScore(v, best)) {
+                    best = v;
+                }
+            }
+            continue;
+        }
+        
+        //the block has an active variable, so its heap does too
+        while (!varActive[heapVars[blockStart[b]]]) {
+            popHeap(b);
+        }
+        int v = heapVars[blockStart[b]];
+        if (best == INVALID || betterScore(v, best)) {
+            best = v;
+        }
+    }
+    
+    //no active clause left in the block
+    if (best != INVALID && score[best] == NO_SCORE) {
+        return INVALID;
+    }
+    
+    return best;
+}
+
+/***************************************************************************
+ Function:  initScores
+ Inputs:    score kind
+ Returns:   none
+ Description:   scores every active variable and orders every block into a
+                heap on those scores. Adding a heuristic only takes a kind,
+                its case in variableScore and a SCORE_KINDS entry
+ ***************************************************************************/
+void formulaState::initScores(int kind) {
+
+    scoreKind = kind;
+    trackSizes = (kind == SCORE_LARGEST_CLAUSE || kind == SCORE_SMALLEST_CLAUSE);
+    if (kind == SCORE_NONE) {
+        return;
+    }
+    
+    //count the active clauses of every size the variables are in
+    if (trackSizes) {
+        sizeWidth = 1;
+        for (int c = 0; c < numClauses; c++) {
+            sizeWidth = max(sizeWidth, db.clauseStart[c + 1] - db.clauseStart[c] + 1);
+        }
+        sizeCount.assign((numVars + 1) * sizeWidth, 0);
+        sizeBound.assign(numVars + 1, 0);
+        for (int c = 0; c < numClauses; c++) {
+            if (!clauseActive[c]) {
+                continue;
+            }
+            for (int l = db.clauseStart[c]; l < db.clauseStart[c + 1]; l++) {
+                int v = abs(db.literals[l]);
+                if (assignment[v] == INVALID) {
+                    addClauseSize(v, clauseSize[c]);
+                }
+            }
+        }
+    }
+    
+    //heapify the active variables of every block
+    score.assign(numVars + 1, NO_SCORE);
+    scoreDirty.assign(numVars + 1, false);
+    dirtyVars.clear();
+    dirtyVars.reserve(numVars);
+    heapVars.assign(numVars + 1, 0);
+    heapPosition.assign(numVars + 1, -1);
+    heapSize.assign(numBlocks, 0);
+    varHeaped.assign(numVars + 1, false);
+    for (int b = 0; b < numBlocks; b++) {
+        if (blockStart[b + 1] - blockStart[b] < heapMinVars) {
+            continue;
+        }
+        for (int i = blockStart[b]; i < blockStart[b] + blockActive[b]; i++) {
+            int v = blockVars[i];
+            score[v] = variableScore(v);
+            heapVars[blockStart[b] + heapSize[b]] = v;
+            heapPosition[v] = blockStart[b] + heapSize[b]++;
+            varHeaped[v] = true;
+        }
+        for (int i = heapSize[b] / 2 - 1; i >= 0; i--) {
+            siftDown(heapVars[blockStart[b] + i]);
+        }
+    }
+}
+
+/***************************************************************************
+ Function:  variableScore
+ Inputs:    variable
+ Returns:   its score, higher is better
+ Description:   computed from the counts kept for the score kind
+ ***************************************************************************/
+int formulaState::variableScore(int variable) {
+
+    switch (scoreKind) {
+        case SCORE_OCCURRENCES:
+            return positiveMembers[variable] + negativeMembers[variable];
+        case SCORE_LARGEST_CLAUSE:
+            return sizeBound[variable] == 0 ? NO_SCORE : sizeBound[variable];
+        case SCORE_SMALLEST_CLAUSE:
+            return sizeBound[variable] == 0 ? NO_SCORE : -sizeBound[variable];
+        default:
+            return NO_SCORE;
+    }
+}
+
+/***************************************************************************
+ Function:  betterScore
+ Inputs:    two variables
+ Returns:   True if the first one goes above the second one in a heap
+ Description:   ties go to the lower variable
+ ***************************************************************************/
+bool formulaState::betterScore(int first, int second) {
+
+    return score[first] > score[second] || (score[first] == score[second] && first < second);
+}
+
+/***************************************************************************
+ Function:  markScore
+ Inputs:    variable whose counts changed
+ Returns:   none
+ Description:   leaves the variable to be scored again before the next
+                split. Counts change many times between two splits and
+                mostly change back, so the heap is only fixed once
+ ***************************************************************************/
+void formulaState::markScore(int variable) {
+
+    if (!scoreDirty[variable] && varHeaped[variable]) {
+        scoreDirty[variable] = true;
+        dirtyVars.push_back(variable);
+    }
+}
+
+/***************************************************************************
+ Function:  rescoreVariable
+ Inputs:    variable whose counts changed
+ Returns:   none
+ Description:   moves the variable to its new place in its block's heap;
+                those out of the heap are scored when they are put back
+ ***************************************************************************/
+void formulaState::rescoreVariable(int variable) {
+
+    if (heapPosition[variable] < 0) {
+        return;
+    }
+    
+    int newScore = variableScore(variable);
+    if (newScore > score[variable]) {
+        score[variable] = newScore;
+        siftUp(variable);
+    }
+    else if (newScore < score[variable]) {
+        score[variable] = newScore;
+        siftDown(variable);
+    }
+}
+
+/***************************************************************************
+ Function:  siftUp
+ Inputs:    variable in a heap
+ Returns:   none
+ Description:   moves the variable up its block's heap while it is better
+                than its parent
+ ***************************************************************************/
+void formulaState::siftUp(int variable) {
+
+    int base = blockStart[varBlock[variable]];
+    int i = heapPosition[variable] - base;
+    while (i > 0) {
+        int parent = heapVars[base + (i - 1) / 2];
+        if (!betterScore(variable, parent)) {
+            break;
+        }
+        heapVars[base + i] = parent;
+        heapPosition[parent] = base + i;
+        i = (i - 1) / 2;
+    }
+    heapVars[base + i] = variable;
+    heapPosition[variable] = base + i;
+}
+
+/***************************************************************************
+ Function:  siftDown
+ Inputs:    variable in a heap
+ Returns:   none
+ Description:   moves the variable down its block's heap while one of its
+                children is better
+ ***************************************************************************/
+void formulaState::siftDown(int variable) {
+
+    int block = varBlock[variable];
+    int base = blockStart[block];
+    int size = heapSize[block];
+    int i = heapPosition[variable] - base;
+    while (2 * i + 1 < size) {
+        int child = 2 * i + 1;
+        if (child + 1 < size && betterScore(heapVars[base + child + 1], heapVars[base + child])) {
+            child++;
+        }
+        int childVar = heapVars[base + child];
+        if (!betterScore(childVar, variable)) {
+            break;
+        }
+        heapVars[base + i] = childVar;
+        heapPosition[childVar] = base + i;
+        i = child;
+    }
+    heapVars[base + i] = variable;
+    heapPosition[variable] = base + i;
+}
+
+/***************************************************************************
+ Function:  pushHeap
+ Inputs:    variable that is not in its block's heap
+ Returns:   none
+ Description:   scores the variable and puts it into the heap
+ ***************************************************************************/
+void formulaState::pushHeap(int variable) {
+
+    int block = varBlock[variable];
+    score[variable] = variableScore(variable);
+    heapPosition[variable] = blockStart[block] + heapSize[block]++;
+    heapVars[heapPosition[variable]] = variable;
+    siftUp(variable);
+}
+
+/***************************************************************************
+ Function:  popHeap
+ Inputs:    block with a non-empty heap
+ Returns:   none
+ Description:   takes the top variable out of the block's heap
+ ***************************************************************************/
+void formulaState::popHeap(int block) {
+
+    int base = blockStart[block];
+    heapPosition[heapVars[base]] = -1;
+    int last = heapVars[base + --heapSize[block]];
+    if (heapSize[block] > 0) {
+        heapVars[base] = last;
+        heapPosition[last] = base;
+        siftDown(last);
+    }
+}
+
+/***************************************************************************
+ Function:  addClauseSize
+ Inputs:    variable, size of an active clause it is now in
+ Returns:   none
+ Description:   counts the clause and updates the variable's size bound
+ ***************************************************************************/
+void formulaState::addClauseSize(int variable, int size) {
+
+    sizeCount[variable * sizeWidth + size]++;
+    int &bound = sizeBound[variable];
+    if (bound == 0 || (scoreKind == SCORE_LARGEST_CLAUSE ? size > bound : size < bound)) {
+        bound = size;
+    }
+}
+
+/***************************************************************************
+ Function:  removeClauseSize
+ Inputs:    variable, size of an active clause it is not in anymore
+ Returns:   none
+ Description:   uncounts the clause; if it was the last one at the bound,
+                the bound moves to the next size the variable still has
+ ***************************************************************************/
+void formulaState::removeClauseSize(int variable, int size) {
+
+    if (--sizeCount[variable * sizeWidth + size] > 0 || size != sizeBound[variable]) {
+        return;
+    }
+    
+    int step = (scoreKind == SCORE_LARGEST_CLAUSE) ? -1 : 1;
+    for (int s = size + step; s > 0 && s < sizeWidth; s += step) {
+        if (sizeCount[variable * sizeWidth + s] > 0) {
+            sizeBound[variable] = s;
+            return;
+        }
+    }
+    sizeBound[variable] = 0;
+}
+
+/***************************************************************************
+ Function:  resizeClause
+ Inputs:    clause, its old size, its new size
+ Returns:   none
+ Description:   moves the clause to its new size for every unassigned
+                variable in it. The new size is counted first, so the bound
+                never has to be searched for when the size changes by one
+ ***************************************************************************/
+void formulaState::resizeClause(int clause, int from, int to) {
+
+    for (int l = db.clauseStart[clause]; l < db.clauseStart[clause + 1]; l++) {
+        int v = abs(db.literals[l]);
+        if (assignment[v] != INVALID) {
+            continue;
+        }
+        addClauseSize(v, to);
+        removeClauseSize(v, from);
+        markScore(v);
+    }
+}
+ 
+/***************************************************************************
+ Function:  firstBlock
+ Inputs:    none
+ Returns:   first quantifier block with an active variable, -1 if none
+ Description: the current block starts there
+ ***************************************************************************/
+int formulaState::firstBlock() {
+
+    for (int b = 0; b < numBlocks; b++) {
+        if (blockActive[b] > 0) {
+            return b;
+        }
+    }
+    return -1;
+}
+
+/***************************************************************************
+ Function:  nextBlock
+ Inputs:    block of the current block
+ Returns:   the next block that is part of the current block, -1 if none
+ Description: blocks of the other quantifier that have no active variable
+                left are not in the way anymore, so the next block of the
+                same quantifier joins the current block
+ ***************************************************************************/
+int formulaState::nextBlock(int block) {
+
+    for (int b = block + 1; b < numBlocks; b++) {
+        if (blockActive[b] > 0) {
+            return blockChoice[b] == blockChoice[block] ? b : -1;
+        }
+    }
+    return -1;
+}
+         
+/***************************************************************************/
+/* UTILITY FUNCTIONS */
+
+/***************************************************************************
+ Function:  isPureChoice
+ Inputs:    variable
+ Returns:   True if the variable is a pure choice variable
+ Description:   checks if variable is a pure choice variable
+ ***************************************************************************/
+pair<bool, int> formulaState::isPureChoice(int variable) {
+
+    if (quantifier[variable] != CHOICE_VALUE) {
+        return pair<bool, int>(false, INVALID);
+    }
+    
+    //it appears with both signs in the active clauses
+    if (positiveMembers[variable] > 0 && negativeMembers[variable] > 0) {
+        return pair<bool, int>(false, INVALID);
+    }
+    
+    //a variable that is in no active clause counts as pure positive
+    if (negativeMembers[variable] > 0) {
+        return pair<bool, int>(true, NEGATIVE);
+    }
+    
+    return pair<bool, int>(true, POSITIVE);
+}
+
+/***************************************************************************
+ Function:  unassigned_var
+ Inputs:    none
+ Returns:   variable
+ Description:   return the next variable in the same block with no assigned value
+ ***************************************************************************/
+int formulaState::unassigned_var() {
+
+    for (int v = 1; v <= numVars; v++) {
+        if (varActive[v]) {
+            return v;
+        }
+    }
+    return INVALID;
+}
+
+/***************************************************************************
+ Function:  resetResult
+ Inputs:    none
+ Returns:   none
+ Description:   reset all counts for numUCP, numPVE, numVS, the cache,
+                component splits, prunes and the parallel search
+ ***************************************************************************/
+void searchCounters::resetResult() {
+
+    numUCP = 0;
+    numPVE = 0;
+    numVS = 0;
+    numCacheHits = 0;
+    numCacheMisses = 0;
+    numCacheBoundHits = 0;
+    numComponentSplits = 0;
+    numChoicePrunes = 0;
+    numChanceLowerPrunes = 0;
+    numChanceUpperPrunes = 0;
+    numComponentPrunes = 0;
+    numBoundJoins = 0;
+    numNodes = 0;
+    numStolenTasks = 0;
+    numLeafSolves = 0;
+#ifdef SSAT_STATS
+    for (int p = 0; p < NUM_PHASES; p++) {
+        phaseNanos[p] = 0;
+        phaseCalls[p] = 0;
+        for (int e = 0; e < NUM_HW_EVENTS; e++) {
+            phaseEvents[p][e] = 0;
+        }
+    }
+    for (int e = 0; e < NUM_HW_EVENTS; e++) {
+        searchEvents[e] = 0;
+    }
+    searchAllocations = 0;
+    depthHistogram.clear();
+#endif
+}
+
+/***************************************************************************
+ Function:  addCounters
+ Inputs:    counters of another search
+ Returns:   none
+ Description:   adds the counts of another search to these
+ ***************************************************************************/
+void searchCounters::addCounters(const searchCounters &other) {
+
+    numUCP += other.numUCP;
+    numPVE += other.numPVE;
+    numVS += other.numVS;
+    numCacheHits += other.numCacheHits;
+    numCacheMisses += other.numCacheMisses;
+    numCacheBoundHits += other.numCacheBoundHits;
+    numComponentSplits += other.numComponentSplits;
+    numChoicePrunes += other.numChoicePrunes;
+    numChanceLowerPrunes += other.numChanceLowerPrunes;
+    numChanceUpperPrunes += other.numChanceUpperPrunes;
+    numComponentPrunes += other.numComponentPrunes;
+    numBoundJoins += other.numBoundJoins;
+    numNodes += other.numNodes;
+    numStolenTasks += other.numStolenTasks;
+    numLeafSolves += other.numLeafSolves;
+#ifdef SSAT_STATS
+    for (int p = 0; p < NUM_PHASES; p++) {
+        phaseNanos[p] += other.phaseNanos[p];
+        phaseCalls[p] += other.phaseCalls[p];
+        for (int e = 0; e < NUM_HW_EVENTS; e++) {
+            phaseEvents[p][e] += other.phaseEvents[p][e];
+        }
+    }
+    for (int e = 0; e < NUM_HW_EVENTS; e++) {
+        searchEvents[e] += other.searchEvents[e];
+    }
+    searchAllocations += other.searchAllocations;
+    if (depthHistogram.size() < other.depthHistogram.size()) {
+        depthHistogram.resize(other.depthHistogram.size(), 0);
+    }
+    for (unsigned int d = 0; d < other.depthHistogram.size(); d++) {
+        depthHistogram[d] += other.depthHistogram[d];
+    }
+#endif
+}
+
+/***************************************************************************/
+/* PRINTING FUNCTIONS */
+
+/***************************************************************************
+ Function:  printClauses
+ Inputs:    none
+ Returns:   none
+ Description:   prints the currently active clauses
+ ***************************************************************************/
+void formulaState::printClauses() {
+
+    cout << "printing clauses " << endl;
+    for (int c = 0; c < numClauses; ++c) {
+        if (!clauseActive[c]) {
+            continue;
+        }
+        cout << c << ":";
+        
+        //only the literals that are not false yet
+        for (int l = db.clauseStart[c]; l < db.clauseStart[c + 1]; ++l) {
+            if (assignment[abs(db.literals[l])] == INVALID) {
+                cout << " " << db.literals[l];
+            }
+        }
+        cout << endl;
+    }
+    cout << endl;
+}
+
+/***************************************************************************
+ Function:  printVariables
+ Inputs:    none
+ Returns:   none
+ Description:   prints the currently active variables
+ ***************************************************************************/
+void formulaState::printVariables() {
+    
+    cout << "printing variable quantifiers " << endl;
+    for (int v = 1; v <= numVars; v++) {
+        if (varActive[v]) {
+            cout << v << " => " << quantifier[v] << endl;
+        }
+    }
+    cout << endl;
+    
+    cout << "printing clause members" << endl;
+    for (int v = 1; v <= numVars; v++) {
+        if (!varActive[v]) {
+            continue;
+        }
+        cout << "Clause Set of variable " << v << endl;
+        for (int o = db.occurrenceStart[v]; o < db.occurrenceStart[v + 1]; o++) {
+            if (clauseActive[db.occurrences[o]]) {
+                cout << db.occurrences[o] << " => "<< db.occurrenceSign[o] << endl;
+            }
+        }
+        cout << endl;
+    }
+}
+
+/***************************************************************************/
+/* READING FILE FUNCTIONS */
+
+/***************************************************************************
+ Function:  readFile
+ Inputs:    file name
+ Returns:   false if the file could not be opened or is neither a .ssat
+            nor a .ssatb file
+ Description:
+            maps the file into memory and loads it into the instance, as a
+            .ssatb file if it starts with SSATB_MAGIC and as text otherwise,
+            then preprocesses it unless --no-preprocess was given. Sets
+            parseTime to the time it took, apart from preprocess
+ ***************************************************************************/
+bool ssatInstance::readFile(string input) {
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    
+#ifdef SSAT_STATS
+    unsigned long long eventStart[NUM_HW_EVENTS];
+    bool counting = perfEnabled && readEvents(eventStart);
+    memset(parseEvents, 0, sizeof(parseEvents));
+#endif
+    
+    int fd = open(input.c_str(), O_RDONLY);
+    
+    // file does not exist, then do nothing
+    if (fd < 0) {
+        return false;
+    }
+    name = input;
+    
+    struct stat info;
+    void* text = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        text = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (text == MAP_FAILED) {
+        return false;
+    }
+    
+    bool valid;
+    if ((size_t)info.st_size >= sizeof(ssatbHeader) && memcmp(text, SSATB_MAGIC, sizeof(SSATB_MAGIC)) == 0) {
+        valid = loadBinary((const char*)text, info.st_size);
+    }
+    else {
+        valid = parseText((const char*)text, info.st_size);
+    }
+    munmap(text, info.st_size);
+    if (!valid) {
+        return false;
+    }
+    
+    numClausesRead = numClauses;
+    memset(preprocessSteps, 0, sizeof(preprocessSteps));
+    double preprocessTime = 0;
+    if (preprocessFormula) {
+        preprocess();
+        for (int s = 0; s < NUM_PREPROCESS_STEPS; s++) {
+            preprocessTime += preprocessSteps[s].seconds;
+        }
+    }
+    
+    buildOccurrences();
+    
+#ifdef SSAT_STATS
+    unsigned long long eventEnd[NUM_HW_EVENTS];
+    if (counting && readEvents(eventEnd)) {
+        addEvents(parseEvents, eventStart, eventEnd);
+    }
+#endif
+    
+    parseTime = chrono::duration<double>(chrono::steady_clock::now() - start).count() - preprocessTime;
+    return true;
+}
+
+/***************************************************************************
+ Function:  parseText
+ Inputs:    text of a .ssat file and its length
+ Returns:   false if it is not a valid .ssat file
+ Description:
+            parses the text in one pass, straight into the instance. The v,
+            c, variables and clauses sections (and the comments of the
+            header) are found by their keyword, wherever they are
+ ***************************************************************************/
+bool ssatInstance::parseText(const char* text, size_t size) {
+
+    textScanner scan;
+    scan.at = text;
+    scan.end = text + size;
+    
+    maximumClauseLength = 0;
+    minimumClauseLength = 0;
+    averageClauseLength = 0;
+    seed = 0;
+    numVars = -1;
+    numClauses = -1;
+    bool valid = true;
+    bool clausesRead = false;
+    
+    //one line at a time, until the clauses have been read
+    while (valid && !clausesRead && scan.skipBlanks()) {
+        
+        //the comments: "; name = value"
+        if (*scan.at == ';') {
+            scan.at++;
+            scan.skipSpaces();
+            if (scan.matchWord("maximum clause length") && scan.skipPast('=')) {
+                valid = scan.readInt(&maximumClauseLength);
+            }
+            else if (scan.matchWord("minimum clause length") && scan.skipPast('=')) {
+                valid = scan.readInt(&minimumClauseLength);
+            }
+            else if (scan.matchWord("average clause length") && scan.skipPast('=')) {
+                valid = scan.readDouble(&averageClauseLength);
+            }
+            else if (scan.matchWord("seed") && scan.skipPast('=')) {
+                valid = scan.readInt(&seed);
+            }
+        }
+        
+        //v
+        else if (scan.matchWord("v")) {
+            valid = scan.readInt(&numVars) && numVars >= 0;
+        }
+        
+        //c
+        else if (scan.matchWord("c")) {
+            valid = scan.readInt(&numClauses) && numClauses >= 0;
+        }
+        
+        //variables: an index and its quantifier per line
+        else if (scan.matchWord("variables")) {
+            valid = numVars >= 0;
+            quantifier.assign(valid ? numVars + 1 : 0, CHOICE_VALUE);
+            for (int i = 0; valid && i < numVars; i++) {
+                int variable;
+                valid = scan.readInt(&variable) && variable >= 1 && variable <= numVars
+                     && scan.readDouble(&quantifier[variable]);
+            }
+        }
+        
+        //clauses: literals up to a 0, sorted and without repeats (as the
+        //set of the old reader kept them)
+        else if (scan.matchWord("clauses")) {
+            valid = numVars >= 0 && numClauses >= 0 && !quantifier.empty();
+            db.literals.clear();
+            db.literals.reserve((size_t)(numClauses * averageClauseLength) + numClauses);
+            db.clauseStart.assign(1, 0);
+            for (int i = 0; valid && i < numClauses; i++) {
+                int literal;
+                while ((valid = scan.readInt(&literal)) && literal != 0) {
+                    valid = abs(literal) <= numVars;
+                    if (!valid) {
+                        break;
+                    }
+                    db.literals.push_back(literal);
+                }
+                vector<int>::iterator first = db.literals.begin() + db.clauseStart.back();
+                sort(first, db.literals.end());
+                db.literals.erase(unique(first, db.literals.end()), db.literals.end());
+                db.clauseStart.push_back(db.literals.size());
+            }
+            clausesRead = true;
+        }
+        
+        scan.skipLine();
+    }
+    
+    return valid && clausesRead;
+}
+
+/***************************************************************************
+ Function:  loadBinary
+ Inputs:    contents of a .ssatb file and its length
+ Returns:   false if it is not a valid .ssatb file of SSATB_VERSION
+ Description:
+            copies the quantifiers, clause offsets and literals of the file
+            into the instance as they are; there is nothing to parse, only
+            the sizes and the order and range of the literals are checked
+ ***************************************************************************/
+bool ssatInstance::loadBinary(const char* data, size_t size) {
+
+    ssatbHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.version != SSATB_VERSION || header.numVars < 0 || header.numClauses < 0) {
+        return false;
+    }
+    
+    //the three arrays follow the header, in this order
+    size_t quantifierBytes = (header.numVars + 1) * sizeof(double);
+    size_t startBytes = (header.numClauses + 1) * sizeof(int32_t);
+    size_t literalBytes = header.numLiterals * sizeof(int32_t);
+    if (size != sizeof(header) + quantifierBytes + startBytes + literalBytes) {
+        return false;
+    }
+    const double* quantifiers = (const double*)(data + sizeof(header));
+    const int32_t* starts = (const int32_t*)(data + sizeof(header) + quantifierBytes);
+    const int32_t* literals = (const int32_t*)(data + sizeof(header) + quantifierBytes + startBytes);
+    
+    numVars = header.numVars;
+    numClauses = header.numClauses;
+    maximumClauseLength = header.maximumClauseLength;
+    minimumClauseLength = header.minimumClauseLength;
+    averageClauseLength = header.averageClauseLength;
+    seed = header.seed;
+    quantifier.assign(quantifiers, quantifiers + numVars + 1);
+    db.clauseStart.assign(starts, starts + numClauses + 1);
+    db.literals.assign(literals, literals + header.numLiterals);
+    
+    if (db.clauseStart[0] != 0 || db.clauseStart[numClauses] != (int)header.numLiterals) {
+        return false;
+    }
+    for (int c = 0; c < numClauses; c++) {
+        if (db.clauseStart[c] > db.clauseStart[c + 1]) {
+            return false;
+        }
+        
+        //the solver relies on every literal of a clause being a different one
+        for (int l = db.clauseStart[c]; l < db.clauseStart[c + 1]; l++) {
+            if (db.literals[l] == 0 || abs(db.literals[l]) > numVars
+                || (l > db.clauseStart[c] && db.literals[l] <= db.literals[l - 1])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/***************************************************************************
+ Function:  writeBinary
+ Inputs:    file name
+ Returns:   false if the file could not be written
+ Description:
+            writes the instance as a .ssatb file: an ssatbHeader, then the
+            quantifiers (numVars + 1 doubles, the first one unused), the
+            clause offsets (numClauses + 1) and the literals (32-bit ints,
+            every clause sorted and without repeats), in native byte order
+ ***************************************************************************/
+bool ssatInstance::writeBinary(string output) {
+
+    ssatbHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SSATB_MAGIC, sizeof(SSATB_MAGIC));
+    header.version = SSATB_VERSION;
+    header.numVars = numVars;
+    header.numClauses = numClauses;
+    header.maximumClauseLength = maximumClauseLength;
+    header.minimumClauseLength = minimumClauseLength;
+    header.seed = seed;
+    header.averageClauseLength = averageClauseLength;
+    header.numLiterals = db.literals.size();
+    
+    vector<int32_t> starts(db.clauseStart.begin(), db.clauseStart.end());
+    vector<int32_t> literals(db.literals.begin(), db.literals.end());
+    
+    ofstream outFile(output.c_str(), ios::binary);
+    if (!outFile.is_open()) {
+        return false;
+    }
+    outFile.write((const char*)&header, sizeof(header));
+    outFile.write((const char*)quantifier.data(), quantifier.size() * sizeof(double));
+    outFile.write((const char*)starts.data(), starts.size() * sizeof(int32_t));
+    outFile.write((const char*)literals.data(), literals.size() * sizeof(int32_t));
+    return outFile.good();
+}
+
+/***************************************************************************
+ Function:  buildOccurrences
+ Inputs:    none
+ Returns:   none
+ Description:
+            builds the per-variable occurrence lists from the literal arena
+            and the state every search starts from
+ ***************************************************************************/
+void ssatInstance::buildOccurrences() {
+
+    //count the occurrences of every variable, then turn the counts into offsets
+    db.occurrenceStart.assign(numVars + 2, 0);
+    for (unsigned int l = 0; l < db.literals.size(); l++) {
+        db.occurrenceStart[abs(db.literals[l]) + 1]++;
+    }
+    for (int v = 1; v <= numVars + 1; v++) {
+        db.occurrenceStart[v] += db.occurrenceStart[v - 1];
+    }
+    
+    //fill the lists clause by clause so that every list is sorted by clause index
+    vector<int> next(db.occurrenceStart.begin(), db.occurrenceStart.end() - 1);
+    db.occurrences.assign(db.literals.size(), 0);
+    db.occurrenceSign.assign(db.literals.size(), 0);
+    for (int c = 0; c < numClauses; c++) {
+        for (int l = db.clauseStart[c]; l < db.clauseStart[c + 1]; l++) {
+            int v = abs(db.literals[l]);
+            db.occurrences[next[v]] = c;
+            db.occurrenceSign[next[v]] = (db.literals[l] > 0) ? POSITIVE : NEGATIVE;
+            next[v]++;
+        }
+    }
+    
+    buildBlocks();
+    initZobrist();
+    initialState = new formulaState(*this);
+    initialState->initRoot();
+}
+
+/***************************************************************************
+ Function:  buildBlocks
+ Inputs:    none
+ Returns:   none
+ Description:
+            splits the prefix into its quantifier blocks
+ ***************************************************************************/
+void ssatInstance::buildBlocks() {
+
+    numBlocks = 0;
+    blockStart.clear();
+    blockChoice.clear();
+    varBlock.assign(numVars + 1, 0);
+    for (int v = 1; v <= numVars; v++) {
+        bool choice = (quantifier[v] == CHOICE_VALUE);
+        if (numBlocks == 0 || blockChoice.back() != choice) {
+            blockStart.push_back(v);
+            blockChoice.push_back(choice);
+            numBlocks++;
+        }
+        varBlock[v] = numBlocks - 1;
+    }
+    blockStart.push_back(numVars + 1);
+}
+
+/***************************************************************************
+ Function:  initZobrist
+ Inputs:    none
+ Returns:   none
+ Description:
+            draws the zobrist codes of the formula's clauses and variables,
+            from a fixed seed so that runs are repeatable
+ ***************************************************************************/
+void ssatInstance::initZobrist() {
+
+    int bits = numClauses + numVars + 1;
+    zobrist.assign(bits, 0);
+    
+    //splitmix64
+    unsigned long long state = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < bits; i++) {
+        unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        zobrist[i] = z ^ (z >> 31);
+    }
+}
+
+/***************************************************************************/
+/* PREPROCESSING */
+
+/***************************************************************************
+ Function:  preprocess
+ Inputs:    none
+ Returns:   none
+ Description:
+            simplifies the clauses once before any search, since every node
+            does work in proportion to them: removes tautologies, duplicate
+            clauses and subsumed clauses, and strengthens clauses by
+            self-subsuming resolution. Every step keeps the formula
+            equivalent for every assignment, so the probability under any
+            prefix stays the same. The variables are left as they are, even
+            those no clause is left in. Times and counts every step in
+            preprocessSteps
+ ***************************************************************************/
+void ssatInstance::preprocess() {
+
+    formulaSimplifier simplifier;
+    simplifier.load(db, numVars, numClauses);
+    
+    for (int s = 0; s < NUM_PREPROCESS_STEPS; s++) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        preprocessStats &stats = preprocessSteps[s];
+        switch (s) {
+            case PREPROCESS_TAUTOLOGIES:
+                simplifier.removeTautologies(stats);
+                break;
+            case PREPROCESS_DUPLICATES:
+                simplifier.removeDuplicates(stats);
+                break;
+            case PREPROCESS_SUBSUMPTION:
+                simplifier.removeSubsumed(stats);
+                break;
+            case PREPROCESS_STRENGTHENING:
+                simplifier.strengthen(stats);
+                break;
+        }
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    
+    simplifier.store(db, &numClauses);
+}
+
+/***************************************************************************
+ Function:  literalCode
+ Inputs:    literal
+ Returns:   2 * variable for a positive literal, 2 * variable + 1 for a
+            negative one
+ ***************************************************************************/
+int literalCode(int literal) {
+    return 2 * abs(literal) + (literal < 0);
+}
+
+/***************************************************************************
+ Function:  load
+ Inputs:    clause arena, number of variables and clauses
+ Returns:   none
+ Description:
+            copies the clauses out of the arena, with their signatures and
+            the occurrence list of every literal
+ ***************************************************************************/
+void formulaSimplifier::load(const clauseDB &db, int numVars, int numClauses) {
+
+    clauses.resize(numClauses);
+    removed.assign(numClauses, false);
+    signature.assign(numClauses, 0);
+    occurrences.assign(2 * (numVars + 1), vector<int>());
+    marked.assign(2 * (numVars + 1), false);
+    for (int c = 0; c < numClauses; c++) {
+        clauses[c].assign(db.literals.begin() + db.clauseStart[c], db.literals.begin() + db.clauseStart[c + 1]);
+        signature[c] = clauseSignature(c, 0, 0);
+        for (unsigned int i = 0; i < clauses[c].size(); i++) {
+            occurrences[literalCode(clauses[c][i])].push_back(c);
+        }
+    }
+}
+
+/***************************************************************************
+ Function:  store
+ Inputs:    clause arena, number of clauses
+ Returns:   none
+ Description:
+            writes the clauses that are left back into the arena, in their
+            order in the file
+ ***************************************************************************/
+void formulaSimplifier::store(clauseDB &db, int* numClauses) {
+
+    db.literals.clear();
+    db.clauseStart.assign(1, 0);
+    for (unsigned int c = 0; c < clauses.size(); c++) {
+        if (!removed[c]) {
+            db.literals.insert(db.literals.end(), clauses[c].begin(), clauses[c].end());
+            db.clauseStart.push_back(db.literals.size());
+        }
+    }
+    *numClauses = db.clauseStart.size() - 1;
+}
+
+/***************************************************************************
+ Function:  removeClause
+ Inputs:    clause, counts of the step that removes it
+ Returns:   none
+ Description:   takes the clause out of the formula
+ ***************************************************************************/
+void formulaSimplifier::removeClause(int clause, preprocessStats &stats) {
+
+    removed[clause] = true;
+    stats.clauses++;
+    stats.literals += clauses[clause].size();
+}
+
+/***************************************************************************
+ Function:  removeTautologies
+ Inputs:    counts of the step
+ Returns:   none
+ Description:
+            removes the clauses that have a literal and its negation, which
+            every assignment satisfies. The literals are sorted, so the
+            negation of a positive literal is found by binary search
+ ***************************************************************************/
+void formulaSimplifier::removeTautologies(preprocessStats &stats) {
+
+    for (unsigned int c = 0; c < clauses.size(); c++) {
+        const vector<int> &clause = clauses[c];
+        for (unsigned int i = 0; i < clause.size(); i++) {
+            if (clause[i] > 0 && binary_search(clause.begin(), clause.end(), -clause[i])) {
+                removeClause(c, stats);
+                break;
+            }
+        }
+    }
+}
+
+/***************************************************************************
+ Function:  removeDuplicates
+ Inputs:    counts of the step
+ Returns:   none
+ Description:
+            removes every clause with the same literals as an earlier one:
+            sorted by their literals, equal clauses are next to each other,
+            the first of them in the file first
+ ***************************************************************************/
+void formulaSimplifier::removeDuplicates(preprocessStats &stats) {
+
+    vector<int> order;
+    for (unsigned int c = 0; c < clauses.size(); c++) {
+        if (!removed[c]) {
+            order.push_back(c);
+        }
+    }
+    stable_sort(order.begin(), order.end(), [this](int first, int second) {
+        return clauses[first] < clauses[second];
+    });
+    for (unsigned int i = 1; i < order.size(); i++) {
+        if (clauses[order[i]] == clauses[order[i - 1]]) {
+            removeClause(order[i], stats);
+        }
+    }
+}
+
+/***************************************************************************
+ Function:  removeSubsumed
+ Inputs:    counts of the step
+ Returns:   none
+ Description:
+            removes every clause that has all the literals of another one.
+            Looking for the clauses each clause subsumes (backward) finds
+            every pair the forward check would: a clause removed before its
+            turn is subsumed by one that subsumes everything it does
+ ***************************************************************************/
+void formulaSimplifier::removeSubsumed(preprocessStats &stats) {
+
+    for (unsigned int c = 0; c < clauses.size(); c++) {
+        if (!removed[c]) {
+            subsumeFrom(c, stats);
+        }
+    }
+}
+
+/***************************************************************************
+ Function:  subsumeFrom
+ Inputs:    clause, counts of the step
+ Returns:   none
+ Description:
+            removes the clauses that have every literal of the clause. Only
+            the clauses of its least frequent literal can, and only those
+            whose signature has every bit of its signature are compared
+ ***************************************************************************/
+void formulaSimplifier::subsumeFrom(int clause, preprocessStats &stats) {
+
+    const vector<int> &literals = clauses[clause];
+    if (literals.empty()) {
+        return;
+    }
+    int rarest = literalCode(literals[0]);
+    for (unsigned int i = 1; i < literals.size(); i++) {
+        if (occurrences[literalCode(literals[i])].size() < occurrences[rarest].size()) {
+            rarest = literalCode(literals[i]);
+        }
+    }
+    
+    for (unsigned int i = 0; i < literals.size(); i++) {
+        marked[literalCode(literals[i])] = true;
+    }
+    const vector<int> &candidates = occurrences[rarest];
+    for (unsigned int i = 0; i < candidates.size(); i++) {
+        int other = candidates[i];
+        if (other == clause || removed[other] || clauses[other].size() < literals.size()
+            || (signature[clause] & ~signature[other]) != 0) {
+            continue;
+        }
+        if (countMarked(other) == (int)literals.size()) {
+            removeClause(other, stats);
         }
     }
-    
-    //variable becomes inactive, removed from variables map
-    variables.erase(variable);
+    for (unsigned int i = 0; i < literals.size(); i++) {
+        marked[literalCode(literals[i])] = false;
+    }
 }
 
-
 /***************************************************************************
- Function:  undoChanges
- Inputs:    structures keeping track of changing data
+ Function:  strengthen
+ Inputs:    counts of the step
  Returns:   none
- Description:   undo changes made before call to SOLVESSAT
+ Description:
+            self-subsuming resolution: if a clause (l or A) and a clause
+            (-l or B) have A a subset of B, their resolvent B subsumes the
+            second clause, so -l is removed from it. A clause that was
+            strengthened is queued again, and the clauses it subsumes now
+            are removed (and counted) here. A literal is never removed from
+            a unit clause, which would leave the empty clause
  ***************************************************************************/
-void undoChanges(int variable, int value, varInfo* savedInfo,
-                 map<int, set<int> >* savedSATClausesPtr,
-                 vector<int>* savedFalseLiteralClausePtr,
-                 map<int, double>* savedInactiveVariables){
-    
-    //put back all inactive variables after the update to variables list
-    for (map<int, double>:: iterator it = (*savedInactiveVariables).begin(); it != (*savedInactiveVariables).end();) {
-        variables[it->first].quantifier = it->second;
-        (*savedInactiveVariables).erase(it++);
+void formulaSimplifier::strengthen(preprocessStats &stats) {
+
+    vector<int> queue;
+    vector<char> queued(clauses.size(), false);
+    for (unsigned int c = 0; c < clauses.size(); c++) {
+        if (!removed[c] && !clauses[c].empty()) {
+            queue.push_back(c);
+            queued[c] = true;
+        }
     }
     
-    //restore info of assigned variable
-    variables[variable].quantifier = (*savedInfo).quantifier;
-    variables[variable].clauseMembers = (*savedInfo).clauseMembers;
-    
-    //put back satisfied clauses to clauses list, going through every clause in the savedSATClauses map
-    for (map<int, set<int> >::iterator it = (*savedSATClausesPtr).begin(); it != (*savedSATClausesPtr).end(); it++) {
-        clauses[it->first] = it->second;
+    vector<int> strengthened;
+    for (unsigned int q = 0; q < queue.size(); q++) {
+        int clause = queue[q];
+        queued[clause] = false;
+        if (removed[clause]) {
+            continue;
+        }
         
-        //going through every literals in the satisfied clause to undo changes made to their clauseMembers maps
-        for (set<int>::iterator iter = (it->second).begin(); iter != (it->second).end(); iter++) {
-
-            //key of variables map is positive
-            int savedVariable = abs(*iter);
+        //the clause with one literal negated at a time is looked for like subsumeFrom does
+        const vector<int> &literals = clauses[clause];
+        strengthened.clear();
+        for (unsigned int i = 0; i < literals.size(); i++) {
+            marked[literalCode(literals[i])] = true;
+        }
+        for (unsigned int i = 0; i < literals.size(); i++) {
+            int flipped = literalCode(-literals[i]);
+            marked[literalCode(literals[i])] = false;
+            marked[flipped] = true;
+            unsigned long long flippedSignature = clauseSignature(clause, i, -literals[i]);
             
-            //put back removed clauses to the corresponding variable's clauseMembers map. We need to make sure
-            //that the value is matched with their original sign.
-            if (*iter > 0) {
-                (variables[savedVariable].clauseMembers).insert(pair<int, int>(it->first, POSITIVE));
-            }
-            else {
-                (variables[savedVariable].clauseMembers).insert(pair<int, int>(it->first, NEGATIVE));
+            const vector<int> &candidates = occurrences[flipped];
+            for (unsigned int j = 0; j < candidates.size(); j++) {
+                int other = candidates[j];
+                if (removed[other] || clauses[other].size() < literals.size() || clauses[other].size() == UNIT_SIZE
+                    || (flippedSignature & ~signature[other]) != 0) {
+                    continue;
+                }
+                if (countMarked(other) == (int)literals.size()) {
+                    vector<int> &otherLiterals = clauses[other];
+                    otherLiterals.erase(find(otherLiterals.begin(), otherLiterals.end(), -literals[i]));
+                    signature[other] = clauseSignature(other, 0, 0);
+                    stats.literals++;
+                    strengthened.push_back(other);
+                }
             }
+            marked[flipped] = false;
+            marked[literalCode(literals[i])] = true;
         }
-    }
-     
-    //going through every clause that the assigned variable appears falsely and put back that variable to the 
-    // right clause in clauses map
-    for (vector<int>::iterator it = (*savedFalseLiteralClausePtr).begin(); it != (*savedFalseLiteralClausePtr).end(); it++) {
-        
-        //put back the variable to its original clause, with the right sign and value
-        if ((variables[variable].clauseMembers)[*it] > 0) {
-            clauses[*it].insert(variable);
+        for (unsigned int i = 0; i < literals.size(); i++) {
+            marked[literalCode(literals[i])] = false;
         }
-        else {
-            clauses[*it].insert(NEGATIVE * variable);
+        
+        //a shorter clause may subsume clauses it did not, and strengthen others
+        for (unsigned int i = 0; i < strengthened.size(); i++) {
+            int other = strengthened[i];
+            if (removed[other]) {
+                continue;
+            }
+            subsumeFrom(other, stats);
+            if (!queued[other]) {
+                queue.push_back(other);
+                queued[other] = true;
+            }
         }
     }
-    
-    //reset the existence of unsatisfiable clause to be false
-    UNSATclauseExists = false;
 }
 
-/***************************************************************************/
-/* SPLITTING HEURISTICS */
-
 /***************************************************************************
- Function:  randomSH
- Inputs:    none
- Returns:   variable
- Description: picks a random variable from the currently active block
+ Function:  countMarked
+ Inputs:    clause
+ Returns:   how many of its literals are marked
  ***************************************************************************/
-int randomSH(){
+int formulaSimplifier::countMarked(int clause) {
 
-    // if there are no variables to choose from, return
-    if (variables.empty() == true) {
-        return INVALID;
+    int count = 0;
+    const vector<int> &literals = clauses[clause];
+    for (unsigned int i = 0; i < literals.size(); i++) {
+        count += marked[literalCode(literals[i])];
     }
-    
-    // gets the vector of variables of the current block
-    vector <int> temp = helperSH();
+    return count;
+}
 
-    srand(time(NULL));
-    
-    // choose a random variable of the block
-    int randNum = rand() % (temp.size());
+/***************************************************************************
+ Function:  clauseSignature
+ Inputs:    clause, position of a literal to put another literal in place
+            of and that literal (0 for none)
+ Returns:   the signature of the clause, with that literal replaced
+ ***************************************************************************/
+unsigned long long formulaSimplifier::clauseSignature(int clause, int skipped, int added) {
 
-    return temp[randNum];
+    unsigned long long bits = 0;
+    const vector<int> &literals = clauses[clause];
+    for (unsigned int i = 0; i < literals.size(); i++) {
+        if (added == 0 || (int)i != skipped) {
+            bits |= 1ULL << (literalCode(literals[i]) % WORD_BITS);
+        }
+    }
+    if (added != 0) {
+        bits |= 1ULL << (literalCode(added) % WORD_BITS);
+    }
+    return bits;
 }
 
+#ifdef SSAT_STATS
 /***************************************************************************
- Function:  maximumSH
- Inputs:    none
- Returns:   int (variable)
- Description:   picks the variable that appears in the most clauses
+ Function:  phaseTimer
+ Inputs:    state, phase to charge its time to
+ Returns:   none
+ Description:
+            pauses the phase the state was in and starts timing this one
  ***************************************************************************/
-int maximumSH() {
+phaseTimer::phaseTimer(formulaState* timed, int phase) {
 
-    // if there are no variables to choose from, return
-    if (variables.empty() == true) {
-        return INVALID;
+    long long now = chrono::duration_cast<chrono::nanoseconds>(
+                        chrono::steady_clock::now().time_since_epoch()).count();
+    state = timed;
+    outer = state->phase;
+    if (outer != PHASE_NONE) {
+        state->phaseNanos[outer] += now - state->phaseStart;
     }
+    state->phase = phase;
+    state->phaseStart = now;
+    state->phaseCalls[phase]++;
     
-    // get the vector of variables of the current block
-    vector <int> temp = helperSH();
-    
-    int max = INT_MIN;
-    int maxIndex;
-    vector <int>::iterator it;
-
-    // go through the block and update the variable that appears in the most clauses
-    for (it = temp.begin(); it!=temp.end(); it++) {
-        if ((int)(variables[(*it)].clauseMembers).size() > max) {
-            max = (variables[(*it)].clauseMembers).size();
-            maxIndex = (*it);
+    unsigned long long events[NUM_HW_EVENTS];
+    if (perfEnabled && readEvents(events)) {
+        if (outer != PHASE_NONE) {
+            addEvents(state->phaseEvents[outer], state->phaseEventStart, events);
         }
+        memcpy(state->phaseEventStart, events, sizeof(events));
     }
-    
-    return maxIndex;
 }
 
 /***************************************************************************
- Function:  maxClause
+ Function:  ~phaseTimer
  Inputs:    none
- Returns:   int (variable)
- Description:   picks the variable that belongs to the biggest active clause     
+ Returns:   none
+ Description:
+            charges the time since the phase was last resumed to it and
+            resumes the phase the state was in before
  ***************************************************************************/
- int maxClause(){
+phaseTimer::~phaseTimer() {
 
-    //get the variables in the current block
-    vector<int> activeBlock = helperSH();
-
-    unsigned int maxSize = 0;       //size of the largest clause found so far
-    unsigned int maxClause = 0;     //index of the largest clause
-    unsigned int maxVar = 1;        //the variable associated with the largest clause
-
-     
-    //for each variable in the active block
-    for (unsigned int i = 0; i < activeBlock.size(); i++) {
+    long long now = chrono::duration_cast<chrono::nanoseconds>(
+                        chrono::steady_clock::now().time_since_epoch()).count();
+    state->phaseNanos[state->phase] += now - state->phaseStart;
+    
+    unsigned long long events[NUM_HW_EVENTS];
+    if (perfEnabled && readEvents(events)) {
+        addEvents(state->phaseEvents[state->phase], state->phaseEventStart, events);
+        memcpy(state->phaseEventStart, events, sizeof(events));
+    }
+    
+    state->phase = outer;
+    state->phaseStart = now;
+}
 
-        //find the largest clause the current variable is a part of
-        unsigned int tempClauseEntry = largestClause(activeBlock[i]);
-        unsigned int tempSize = (clauses[tempClauseEntry]).size();
+/***************************************************************************/
+/* HEAP ALLOCATIONS */
 
-        //if the clause is larger than the currently saved one, update
-        if (maxSize < tempSize) {
-            maxSize = tempSize;
-            maxClause = tempClauseEntry;
-            maxVar = activeBlock[i];
-        }
+/***************************************************************************
+ Function:  operator new
+ Inputs:    bytes to allocate
+ Returns:   the memory
+ Description:   the global allocation function of a stats build, which
+                counts the allocations of every thread so that the stats
+                show what the search still takes from the heap. new[] and
+                the standard containers come through here as well
+ ***************************************************************************/
+void* operator new(size_t size) {
 
+    heapAllocations++;
+    void* memory = malloc(size ? size : 1);
+    if (memory == NULL) {
+        throw bad_alloc();
     }
+    return memory;
+}
 
-    if (clauses[maxClause].empty() == true) {
-        return INVALID;
-    }
+/***************************************************************************
+ Function:  operator delete
+ Inputs:    memory from operator new
+ Returns:   none
+ Description:   frees memory of the counting operator new
+ ***************************************************************************/
+void operator delete(void* memory) noexcept {
 
-    return maxVar;
- }
+    free(memory);
+}
 
- /***************************************************************************
- Function:  minClause
- Inputs:    none
- Returns:   int (variable)
- Description:   picks the variable that belongs to the smallest active clause
- ***************************************************************************/
- int minClause() {
+/***************************************************************************/
+/* HARDWARE COUNTERS */
 
-    //get the variables in the current block
-    vector<int> activeBlock = helperSH();
+/***************************************************************************
+ Function:  readEvents
+ Inputs:    where to write the count of every HW_EVENT_NAMES event
+ Returns:   false if this thread cannot count hardware events (not linux,
+            no perf support, or not allowed, as in many containers)
+ Description:
+            reads the calling thread's counters; events the machine does
+            not have read as 0
+ ***************************************************************************/
+bool readEvents(unsigned long long* values) {
 
-    unsigned int minSize = INT_MAX;         //smallest clause size found so far
-    unsigned int minClause = INT_MAX;       //index of smallest clause
-    unsigned int minVar = 1;                //the variable associated with the current smallest clause
+#ifdef SSAT_PERF
+    return threadCounters.read(values);
+#else
+    return false;
+#endif
+}
 
-    //for each variable in the active block
-    for (unsigned int i = 0; i < activeBlock.size(); i++) {
+/***************************************************************************
+ Function:  addEvents
+ Inputs:    totals, counts at the start and at the end of a stretch
+ Returns:   none
+ Description:
+            adds the events of the stretch to the totals
+ ***************************************************************************/
+void addEvents(unsigned long long* total, const unsigned long long* start, const unsigned long long* end) {
 
-        //find the smallest clause the current variable is a part of
-        unsigned int tempClauseEntry = smallestClause(activeBlock[i]);
-        unsigned int tempSize = (clauses[tempClauseEntry]).size();
+    for (int e = 0; e < NUM_HW_EVENTS; e++) {
+        total[e] += end[e] - start[e];
+    }
+}
 
-        //if the clause is smaller than the current saved one, update
-        if (minSize > tempSize) {
-            minSize = tempSize;
-            minClause = tempClauseEntry;
-            minVar = activeBlock[i];
-        }
+/***************************************************************************
+ Function:  perfCounters
+ Inputs:    none
+ Returns:   none
+ Description:
+            nothing is opened until the thread first reads its counters
+ ***************************************************************************/
+perfCounters::perfCounters() {
 
+    opened = false;
+    groupFd = -1;
+    numSlots = 0;
+    for (int e = 0; e < NUM_HW_EVENTS; e++) {
+        fds[e] = -1;
+        slot[e] = -1;
     }
+}
 
-    if (clauses[minClause].empty() == true) {
-        return INVALID;
+/***************************************************************************
+ Function:  ~perfCounters
+ Inputs:    none
+ Returns:   none
+ Description:
+            closes the counters when their thread ends
+ ***************************************************************************/
+perfCounters::~perfCounters() {
+
+    for (int e = 0; e < NUM_HW_EVENTS; e++) {
+        if (fds[e] >= 0) {
+            close(fds[e]);
+        }
     }
+}
 
-    return minVar;
- }
- 
- /***************************************************************************
- Function:  helperSH
+/***************************************************************************
+ Function:  open
  Inputs:    none
- Returns:   vector representing the currently active block
- Description: determines the variables of the same block and put all into
-                one vector
+ Returns:   none
+ Description:
+            opens a counter of the calling thread for every event it can,
+            user space only, all in one group led by the first that opens
  ***************************************************************************/
-vector<int> helperSH() {
+void perfCounters::open() {
 
-    vector <int> temp;
-    double previous;
-    bool started = false;
+    opened = true;
+#ifdef SSAT_PERF
+    static const unsigned long long EVENT_CONFIGS[] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
     
-    map<int, varInfo>::iterator it;
-    //iterates through variables map
-    for (it = variables.begin(); it!=variables.end(); ++it) { 
-        // gets the first variable and its quantifier of the map
-        if (!started) {
-            started = true;
-            previous = (it->second).quantifier;
-            temp.push_back(it->first);
+    for (int e = 0; e < NUM_HW_EVENTS; e++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = EVENT_CONFIGS[e];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        
+        fds[e] = syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+        if (fds[e] < 0) {
+            continue;
         }
-        // otherwise, it checks if the other quantifiers are part of the same block
-        else {
-            if (previous * (it->second).quantifier < 0) {
-                // different block then return
-                break;
-            }
-            else {
-                temp.push_back(it->first);
-                previous = (it->second).quantifier;
-            }
+        if (groupFd < 0) {
+            groupFd = fds[e];
         }
+        slot[e] = numSlots++;
+        hwEventsOpened |= 1 << e;
     }
-    
-    // returns a vector of the variables
-    return temp;
+#endif
 }
-         
-/***************************************************************************/
-/* UTILITY FUNCTIONS */
 
 /***************************************************************************
- Function:  isPureChoice
- Inputs:    variable
- Returns:   True if the variable is a pure choice variable
- Description:   checks if variable is a pure choice variable
+ Function:  read
+ Inputs:    where to write the count of every event
+ Returns:   false if no event could be opened
+ Description:
+            reads the whole group at once
  ***************************************************************************/
-pair<bool, int> isPureChoice(int variable) {
+bool perfCounters::read(unsigned long long* values) {
 
-    varInfo info = variables[variable];
-    if (info.quantifier != CHOICE_VALUE) {
-        return pair<bool, int>(false, INVALID);
+    if (!opened) {
+        open();
+    }
+    if (groupFd < 0) {
+        return false;
     }
     
-    map<int, int>* clauseInfo = &(info.clauseMembers);
-    int status = POSITIVE;
-    bool signSwitch = false;
+    //the number of events, then their counts
+    unsigned long long group[NUM_HW_EVENTS + 1];
+    if (::read(groupFd, group, sizeof(group)) < (ssize_t)((numSlots + 1) * sizeof(unsigned long long))) {
+        return false;
+    }
+    for (int e = 0; e < NUM_HW_EVENTS; e++) {
+        values[e] = slot[e] >= 0 ? group[slot[e] + 1] : 0;
+    }
+    return true;
+}
+#endif
+
+/***************************************************************************
+ Function:  formulaState
+ Inputs:    instance the state searches
+ Returns:   none
+ Description:
+            a state of the instance with nothing set up yet; initRoot or a
+            copy of the instance's initial state gives it a formula
+ ***************************************************************************/
+formulaState::formulaState(const ssatInstance &instance) :
+    db(instance.db), quantifier(instance.quantifier), zobrist(instance.zobrist),
+    blockStart(instance.blockStart), blockChoice(instance.blockChoice), varBlock(instance.varBlock),
+    numVars(instance.numVars), numClauses(instance.numClauses), numBlocks(instance.numBlocks) {
     
-    for (map<int, int>::iterator it = (*clauseInfo).begin(); it != (*clauseInfo).end(); it++) {
-        if (!signSwitch) {
-            status = it->second;
-            signSwitch = true;
-        }
-        else {
-            if (status != it->second) {
-                return pair<bool, int>(false, INVALID);
+    cache = NULL;
+    context = NULL;
+    worker = 0;
+    depth = 0;
+#ifdef SSAT_STATS
+    phase = PHASE_NONE;
+    phaseStart = 0;
+#endif
+    resetResult();
+}
+
+/***************************************************************************
+ Function:  initRoot
+ Inputs:    none
+ Returns:   none
+ Description:
+            sets up the search state with every clause and variable active
+ ***************************************************************************/
+void formulaState::initRoot() {
+
+    //everything is active before the search starts
+    assignment.assign(numVars + 1, INVALID);
+    varActive.assign(numVars + 1, true);
+    varActive[0] = false;
+    positiveMembers.assign(numVars + 1, 0);
+    negativeMembers.assign(numVars + 1, 0);
+    for (int v = 1; v <= numVars; v++) {
+        for (int o = db.occurrenceStart[v]; o < db.occurrenceStart[v + 1]; o++) {
+            if (db.occurrenceSign[o] == POSITIVE) {
+                positiveMembers[v]++;
+            }
+            else {
+                negativeMembers[v]++;
             }
         }
     }
+    clauseActive.assign(numClauses, true);
+    clauseSize.assign(numClauses, 0);
+    for (int c = 0; c < numClauses; c++) {
+        clauseSize[c] = db.clauseStart[c + 1] - db.clauseStart[c];
+    }
+    numActiveVars = numVars;
+    numActiveClauses = numClauses;
+    UNSATclauseExists = false;
+    
+    //every variable is active, in order
+    blockVars.resize(numVars + 1);
+    blockPosition.resize(numVars + 1);
+    for (int v = 0; v <= numVars; v++) {
+        blockVars[v] = v;
+        blockPosition[v] = v;
+    }
+    blockActive.resize(numBlocks);
+    for (int b = 0; b < numBlocks; b++) {
+        blockActive[b] = blockStart[b + 1] - blockStart[b];
+    }
+    trackBlocks = true;
+    scoreKind = SCORE_NONE;
+    trackSizes = false;
+    
+    //the trail never holds more than one entry per variable, clause and literal,
+    //so it is allocated once here and never grows during the search
+    trail.clear();
+    trail.reserve(2 * numVars + numClauses + db.literals.size());
     
-    return pair<bool, int>(true, status);
+    //every frame has fewer active variables than the one that pushed it, so
+    //a search never has more than numVars + 1 frames open
+    frames.clear();
+    frames.reserve(numVars + 1);
+    
+    initFormulaKey();
+    varComponent.assign(numVars + 1, 0);
+    clauseComponent.assign(numClauses, 0);
+    componentQueue.assign(numVars + 1, 0);
+    componentLabel = 0;
+    initBitset();
+    reserveScratch();
 }
 
 /***************************************************************************
- Function:  unassigned_var
+ Function:  reserveScratch
  Inputs:    none
- Returns:   variable
- Description:   return the next variable in the same block with no assigned value
+ Returns:   none
+ Description:
+            allocates the buffers the search fills lazily at their largest
+            (or, for the component scratch, first-split) size, so that the
+            nodes themselves never call operator new. Copies of a state do
+            not keep capacity, so every copy calls this again
  ***************************************************************************/
-int unassigned_var() {
+void formulaState::reserveScratch() {
 
-    if (variables.empty() == true) {
-        return INVALID;
+    //a leaf formula has at most leafMaxVars variables, its table 2^leafMaxVars bits
+    int leafSize = 1 << leafMaxVars;
+    leafVars.reserve(leafMaxVars);
+    leafBit.reserve(numVars + 1);
+    leafTable.reserve(max(1, leafSize / WORD_BITS));
+    leafClause.reserve(max(1, leafSize / WORD_BITS));
+    leafValues.reserve(leafSize);
+    
+    //one split of the whole formula; nested splits of the same depth of
+    //components reuse what the split before them freed
+    componentScratch.reserve(2 * (numVars + numClauses));
+    if (bitWords > 0) {
+        bitScratch.reserve((clauseWords + bitWords) * (numVars + 1));
     }
-    return variables.begin()->first;
+#ifdef SSAT_STATS
+    depthHistogram.reserve(numVars + 1);
+#endif
 }
 
 /***************************************************************************
- Function:  resetResult
+ Function:  skipBlanks
  Inputs:    none
- Returns:   none
- Description:   reset all counts for numUCP, numPVE and numVS
+ Returns:   false at the end of the text
+ Description: moves to the next character that is not white space
  ***************************************************************************/
-void resetResult() {
+bool textScanner::skipBlanks() {
 
-    numUCP = 0;
-    numPVE = 0;
-    numVS = 0;
+    while (at < end && isspace((unsigned char)*at)) {
+        at++;
+    }
+    return at < end;
 }
 
 /***************************************************************************
- Function:  largestClause
- Inputs:    variable
- Returns:   clause
- Description:
-        returns the clause that has the most variables within a variable's clauseSet
+ Function:  skipSpaces
+ Inputs:    none
+ Returns:   none
+ Description: moves past spaces and tabs, but not past the end of the line
  ***************************************************************************/
-int largestClause(int variable) {
+void textScanner::skipSpaces() {
 
-    unsigned int maxSize = 0;
-    unsigned int maxClause = 0;
-
-    //for every clause the variable is a part of, check if it is larger than the current saved max clause and update if so
-    for (map<int, int>::iterator it = variables[variable].clauseMembers.begin(); it != variables[variable].clauseMembers.end(); it++) {
-        
-        if (maxSize < clauses[it->first].size()) {
-            maxSize = clauses[it->first].size();
-            maxClause = it->first;
-        }
+    while (at < end && (*at == ' ' || *at == '\t')) {
+        at++;
     }
-
-    return maxClause;
 }
 
 /***************************************************************************
- Function:  smallestClause
- Inputs:    variable
- Returns:   clause
- Description:
-        returns the clause that has the least variables within a variable's clauseSet
+ Function:  skipLine
+ Inputs:    none
+ Returns:   none
+ Description: moves to the start of the next line
  ***************************************************************************/
-int smallestClause(int variable) {
+void textScanner::skipLine() {
 
-    unsigned int minSize = INT_MAX;
-    unsigned int minClause = INT_MAX;
+    while (at < end && *at != '\n') {
+        at++;
+    }
+}
 
-    //for every clause the variable is a part of, check if it is smaller than the current saved min clause and update if so
-    for (map<int, int>::iterator it = variables[variable].clauseMembers.begin(); it != variables[variable].clauseMembers.end(); it++) {
-        
-        if (minSize > clauses[it->first].size()) {
-            minSize = clauses[it->first].size();
-            minClause = it->first;
+/***************************************************************************
+ Function:  skipPast
+ Inputs:    character
+ Returns:   false if the line does not have it
+ Description: moves past the next c of the current line
+ ***************************************************************************/
+bool textScanner::skipPast(char c) {
+
+    while (at < end && *at != '\n') {
+        if (*at++ == c) {
+            return true;
         }
     }
-
-    return minClause;
+    return false;
 }
 
-/***************************************************************************/
-/* PRINTING FUNCTIONS */
-
 /***************************************************************************
- Function:  printClauses
- Inputs:    none
- Returns:   none
- Description:   prints the currently active clauses
+ Function:  matchWord
+ Inputs:    word (may hold single spaces, which match any run of them)
+ Returns:   true if the text goes on with the word and then white space
+ Description: moves past the word and the spaces after it if it matches
  ***************************************************************************/
-void printClauses() {
+bool textScanner::matchWord(const char* word) {
 
-    cout << "printing clauses " << endl;
-    map<int, set <int> >::iterator it;
-    for (it = clauses.begin(); it!=clauses.end(); ++it) {
-        cout << it->first << ":";
-        set<int>::iterator iter;
-        
-        for (iter = (it->second).begin(); iter!=(it->second).end();++iter) {
-            cout << " " << (*iter);
+    const char* p = at;
+    while (*word) {
+        if (*word == ' ') {
+            if (p >= end || (*p != ' ' && *p != '\t')) {
+                return false;
+            }
+            while (p < end && (*p == ' ' || *p == '\t')) {
+                p++;
+            }
+            word++;
+        }
+        else if (p < end && *p == *word) {
+            p++;
+            word++;
+        }
+        else {
+            return false;
         }
-        cout << endl;
     }
-    cout << endl;
+    if (p < end && !isspace((unsigned char)*p)) {
+        return false;
+    }
+    at = p;
+    skipSpaces();
+    return true;
 }
 
 /***************************************************************************
- Function:  printVariables
- Inputs:    none
- Returns:   none
- Description:   prints the currently active variables
+ Function:  readInt
+ Inputs:    where to write the number
+ Returns:   false if the next word is not an integer
+ Description: reads an integer after any white space
  ***************************************************************************/
-void printVariables() {
-    
-    map<int, varInfo>::iterator it;
-    
-    cout << "printing variable quantifiers " << endl;
-    for(it = variables.begin(); it != variables.end(); it++){
-        cout << it->first << " => " << (it->second).quantifier << endl;
+bool textScanner::readInt(int* value) {
+
+    if (!skipBlanks()) {
+        return false;
     }
-    cout << endl;
-    
-    cout << "printing varInfo" << endl;
-    for (it = variables.begin(); it != variables.end(); it++) {
-        map<int, int>::iterator itClause = (it->second).clauseMembers.begin();
-        cout << "Clause Set of variable " << it->first << endl;
-        for (; itClause != (it->second).clauseMembers.end(); itClause++) {
-            cout << itClause->first << " => "<< itClause->second << endl;
+    bool negative = (*at == '-');
+    if (*at == '-' || *at == '+') {
+        at++;
+    }
+    if (at >= end || !isdigit((unsigned char)*at)) {
+        return false;
+    }
+    long long number = 0;
+    while (at < end && isdigit((unsigned char)*at)) {
+        number = number * 10 + (*at++ - '0');
+        if (number > INT_MAX) {
+            return false;
         }
-        cout << endl;
     }
+    *value = (int)(negative ? -number : number);
+    return true;
 }
 
-/***************************************************************************/
-/* READING FILE FUNCTIONS */
-
 /***************************************************************************
- Function:  readFile
- Inputs:    file name
- Returns:   none
- Description:
-            reads the content of file and stores the information as global
-            variables
+ Function:  readDouble
+ Inputs:    where to write the number
+ Returns:   false if the next word is not a number
+ Description: reads a decimal number after any white space. Digits / 10^k
+              is rounded correctly while both are exact doubles, which
+              covers every probability of a .ssat file; anything longer or
+              with an exponent goes through strtod
  ***************************************************************************/
-void readFile(string input) {
+bool textScanner::readDouble(double* value) {
 
-    string sTemp;
-    ifstream inFile;
-    vector<string> vSTemp;
-    set<int> vITemp;
-    int i;
+    static const double POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+                                           1e11, 1e12, 1e13, 1e14, 1e15};
     
-    inFile.open(input.c_str());
-    
-    // file does not exist, then do nothing
-    if (!inFile.is_open()) {
-        cout << "File is not valid" << endl;
-        exit(1);
+    if (!skipBlanks()) {
+        return false;
     }
-    
-    // skips the initial 4 lines
-    i = 4;
-    while (i >= 0) {
-        getline(inFile, sTemp);
-        i--;
+    const char* first = at;
+    bool negative = (*at == '-');
+    if (*at == '-' || *at == '+') {
+        at++;
     }
     
-    //the comments
-    tokenize(sTemp, vSTemp);
-    maximumClauseLength = stoi(vSTemp.back());
-    
-    getline(inFile, sTemp);
-    tokenize(sTemp, vSTemp);
-    minimumClauseLength = stoi(vSTemp.back());
-    
-    getline(inFile, sTemp);
-    tokenize(sTemp, vSTemp);
-    averageClauseLength = stod(vSTemp.back());
-    
-    getline(inFile, sTemp);
-    tokenize(sTemp, vSTemp);
-    seed = stoi(vSTemp.back());
-    
-    getline(inFile, sTemp);
-    
-    //v
-    getline(inFile, sTemp);
-    tokenize(sTemp, vSTemp);
-    numVars = stoi(vSTemp.back());
-    
-    //c
-    getline(inFile, sTemp);
-    vSTemp.clear();
-    tokenize(sTemp, vSTemp);
-    numClauses = stoi(vSTemp.back());
-    
-    getline(inFile, sTemp);
-    getline(inFile, sTemp);
-    
-    //variables
-    i = numVars;
-    unsigned int count = 1;
-    while (i > 0) {
-        getline(inFile, sTemp);
-        vSTemp.clear();
-        tokenize(sTemp, vSTemp);
-        
-        varInfo var;
-        for (unsigned int b = 0; b <= vSTemp.size(); b++) {
-            if (b%2 == 1) {
-                var.quantifier = stod(vSTemp.at(b));
-                variables.insert(pair<int, varInfo>(count, var));
-            }
+    unsigned long long digits = 0;
+    int numDigits = 0;
+    int decimals = 0;
+    bool point = false;
+    while (at < end && (isdigit((unsigned char)*at) || (*at == '.' && !point))) {
+        if (*at == '.') {
+            point = true;
         }
-        
-        count++;
-        i--;
+        else {
+            digits = digits * 10 + (*at - '0');
+            numDigits++;
+            decimals += point;
+        }
+        at++;
+    }
+    if (numDigits == 0) {
+        return false;
     }
     
-    getline(inFile, sTemp);
-    getline(inFile, sTemp);
-    
-    for (i = 0; i < numClauses; i++){
-        vSTemp.clear();
-        getline(inFile, sTemp);
-        tokenize(sTemp, vSTemp);
-        vSTemp.pop_back();
-        
-        for (unsigned int j = 0; j < vSTemp.size(); j++) {
-            int num = stoi(vSTemp[j].c_str());
-            vITemp.insert(num);
-            
-            if (num > 0) {
-                ((variables[abs(num)]).clauseMembers).insert(pair<int, int>(i, POSITIVE));
-            }
-            else {
-                ((variables[abs(num)]).clauseMembers).insert(pair<int, int>(i, NEGATIVE));
-            }
+    if (numDigits <= 15 && (at >= end || (*at != 'e' && *at != 'E'))) {
+        *value = (double)digits / POWERS_OF_TEN[decimals];
+        if (negative) {
+            *value = -*value;
         }
-        
-        clauses.insert(pair<int, set<int> >(i,vITemp));
-        vITemp.clear();
+        return true;
     }
     
-    inFile.close();
-    cout << "File read successfully" << endl;
-}
-
-/***************************************************************************
- Function:  tokenize
- Inputs:    string and vector
- Returns:   none (but the second parameter is modified)
- Description: splits a string by whitespace
- ***************************************************************************/
-void tokenize(string str, vector<string> &token_v) {
-
-    size_t start = str.find_first_not_of(' '), end=start;
-    
-    while(start != string::npos) {
-        // Find next occurence of delimiter
-        end = str.find(' ', start);
-        // Push back the token found into vector
-        token_v.push_back(str.substr(start, end-start));
-        // Skip all occurences of the delimiter to find new start
-        start = str.find_first_not_of(' ', end);
+    //the mapped file has no terminating 0, so strtod reads a copy
+    char number[64];
+    while (at < end && !isspace((unsigned char)*at)) {
+        at++;
+    }
+    size_t length = at - first;
+    if (length >= sizeof(number)) {
+        return false;
     }
+    memcpy(number, first, length);
+    number[length] = 0;
+    char* stop;
+    *value = strtod(number, &stop);
+    return stop == number + length;
 }
 
 /****** END OF FILE **********************************************************/
\ No newline at end of file
@@ -0,0 +1,97 @@
+#!/bin/bash
+# Checks of the solver against itself: runs that must give the same output
+# in different modes. Usage: tests/check.sh [solver binary] (default ./ssat),
+# from the top of the repository. Exits with 1 if a check failed.
+
+solver=${1:-./ssat}
+failed=0
+
+# the output of a run without the lines that differ from run to run
+counters() {
+    "$solver" "$@" | grep -v -e TIME -e SHORTCUTS -e "STOLEN SUBTREES" -e "NODES ON THREAD"
+}
+
+# prints the check's result and remembers a failure
+report() {
+    if [ "$2" = "0" ]; then
+        echo "PASS $1"
+    else
+        echo "FAIL $1"
+        failed=1
+    fi
+}
+
+# a subtree stolen by another thread is searched like the owner would have
+# searched it, so without the cache and bounds (off by default, their contents
+# depend on the order the subtrees are solved in) the counters do not depend
+# on --threads
+check_stolen_counters() {
+    local algorithms="--algorithms NAIVE,UCPONLY,PVEONLY,UCPPVE,MAXVAR,MINCLAUSE,MAXCLAUSE"
+    local result=0
+    for file in newProblems/er1.ssat newProblems/rere2.ssat newProblems/re2.ssat; do
+        if ! diff <(counters $algorithms --threads 1 $file) \
+                  <(counters $algorithms --threads 4 $file) > /dev/null; then
+            echo "  counters of $file differ with --threads 4"
+            result=1
+        fi
+    done
+    report "stolen subtrees give the counters of local ones" $result
+}
+
+# --convert writes the formula as it is in the file: the .ssatb file solves
+# exactly like the .ssat file (clause order included), and converting it
+# again gives the same bytes
+check_convert_roundtrip() {
+    local binary=$(mktemp) again=$(mktemp)
+    local result=0
+    for file in oldproblems/small5.ssat newProblems/erer3.ssat; do
+        "$solver" --convert $binary $file > /dev/null
+        "$solver" --convert $again $binary > /dev/null
+        if ! cmp -s $binary $again; then
+            echo "  converting $file twice gives different files"
+            result=1
+        fi
+        if ! diff <(counters $file) <(counters $binary) > /dev/null; then
+            echo "  $file and its .ssatb file solve differently"
+            result=1
+        fi
+    done
+    rm -f $binary $again
+    report "--convert keeps the formula as it is in the file" $result
+}
+
+# the shortcuts of --fast change the counts but not the probabilities
+check_fast_results() {
+    local result=0
+    for file in oldproblems/small3.ssat newProblems/er2.ssat newProblems/rere1.ssat; do
+        if ! diff <(counters $file | grep RESULT) <(counters --fast $file | grep RESULT) > /dev/null; then
+            echo "  results of $file differ with --fast"
+            result=1
+        fi
+    done
+    report "--fast gives the results of a plain run" $result
+}
+
+# the heap of a block's scores picks the variables a scan of the block picks;
+# no bundled block reaches the default --heap-min-vars, so every block is put
+# in a heap here and compared against scanning them all
+check_heap_scores() {
+    local scored="--no-bitset --algorithms MAXVAR,MINCLAUSE,MAXCLAUSE"
+    local result=0
+    for file in newProblems/e1.ssat newProblems/er1.ssat newProblems/re1.ssat \
+                newProblems/erer1.ssat newProblems/rere1.ssat; do
+        if ! diff <(counters $scored --heap-min-vars 1 $file) \
+                  <(counters $scored --heap-min-vars 100000 $file) > /dev/null; then
+            echo "  heaps and scans of $file pick different variables"
+            result=1
+        fi
+    done
+    report "heaps pick the variables of scans" $result
+}
+
+check_stolen_counters
+check_convert_roundtrip
+check_heap_scores
+check_fast_results
+
+exit $failed